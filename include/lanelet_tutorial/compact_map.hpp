@@ -0,0 +1,269 @@
+#ifndef LANELET_TUTORIAL__COMPACT_MAP_HPP_
+#define LANELET_TUTORIAL__COMPACT_MAP_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet_tutorial/planar_geometry.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Read-only, compressed copy of the point geometry of a LaneletMap. Every
+// lanelet::Point3d carries its own PointData (3 doubles, id, attribute map,
+// reference count); here coordinates are quantized to millimeters relative to
+// the origin of a tile, stored as zigzag varint deltas along each line string,
+// and ids and (non-empty) attributes live in side tables. Queries decode the
+// coordinates on the fly.
+
+namespace lanelet_tutorial::compact {
+
+constexpr double Resolution = 1e-3; // [m]
+constexpr double TileSize = 1000.;  // [m]
+
+namespace detail {
+inline void putVarint(std::vector<std::uint8_t> &out, std::int64_t value) {
+  auto zigzag = (static_cast<std::uint64_t>(value) << 1) ^
+                static_cast<std::uint64_t>(value >> 63);
+  while (zigzag >= 0x80) {
+    out.push_back(static_cast<std::uint8_t>(zigzag) | 0x80);
+    zigzag >>= 7;
+  }
+  out.push_back(static_cast<std::uint8_t>(zigzag));
+}
+
+inline std::int64_t getVarint(const std::uint8_t *&in) {
+  std::uint64_t zigzag = 0;
+  for (int shift = 0;; shift += 7) {
+    std::uint8_t byte = *in++;
+    zigzag |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  return static_cast<std::int64_t>(zigzag >> 1) ^
+         -static_cast<std::int64_t>(zigzag & 1);
+}
+
+// offsets and counts in the tables are 32 bit
+inline std::uint32_t checkedIndex(std::size_t value, const char *what) {
+  if (value > std::numeric_limits<std::uint32_t>::max())
+    throw std::length_error(std::string("Too many ") + what +
+                            " for the compact map");
+  return static_cast<std::uint32_t>(value);
+}
+
+inline std::int64_t quantize(double value) {
+  return std::llround(value / Resolution);
+}
+} // namespace detail
+
+class CompactMap {
+public:
+  explicit CompactMap(const lanelet::LaneletMap &map) {
+    std::unordered_set<lanelet::Id> onLineString;
+    for (const auto &ls : map.lineStringLayer) {
+      add(ls.id(), ls);
+      for (const auto &p : ls)
+        onLineString.insert(p.id());
+    }
+    // points that are not part of any line string become single point records
+    for (const auto &p : map.pointLayer)
+      if (onLineString.count(p.id()) == 0)
+        add(lanelet::InvalId, std::vector<lanelet::ConstPoint3d>{p});
+    for (const auto &p : map.pointLayer)
+      if (!p.attributes().empty())
+        pointAttributes_.emplace(p.id(), p.attributes());
+
+    pointSlots_.resize(pointIds_.size());
+    std::iota(pointSlots_.begin(), pointSlots_.end(), std::uint32_t(0));
+    std::stable_sort(pointSlots_.begin(), pointSlots_.end(),
+                     [&](std::uint32_t a, std::uint32_t b) {
+                       return pointIds_[a] < pointIds_[b];
+                     });
+    // a point shared by several line strings only needs one slot for lookups
+    pointSlots_.erase(std::unique(pointSlots_.begin(), pointSlots_.end(),
+                                  [&](std::uint32_t a, std::uint32_t b) {
+                                    return pointIds_[a] == pointIds_[b];
+                                  }),
+                      pointSlots_.end());
+    pointSlots_.shrink_to_fit();
+    std::sort(lineStringIndex_.begin(), lineStringIndex_.end());
+    bytes_.shrink_to_fit();
+    pointIds_.shrink_to_fit();
+  }
+
+  // calls f(id, BasicPoint3d) for each point of the line string, in order.
+  // Returns false if the map has no line string with this id
+  template <typename Func> bool forEachPoint(lanelet::Id lsId, Func &&f) const {
+    auto it = std::lower_bound(lineStringIndex_.begin(), lineStringIndex_.end(),
+                               std::make_pair(lsId, std::uint32_t(0)));
+    if (it == lineStringIndex_.end() || it->first != lsId)
+      return false;
+    decode(records_[it->second], records_[it->second].size,
+           std::forward<Func>(f));
+    return true;
+  }
+
+  lanelet::Optional<lanelet::BasicPoint3d> point(lanelet::Id id) const {
+    auto it = std::lower_bound(
+        pointSlots_.begin(), pointSlots_.end(), id,
+        [&](std::uint32_t slot, lanelet::Id value) {
+          return pointIds_[slot] < value;
+        });
+    if (it == pointSlots_.end() || pointIds_[*it] != id)
+      return {};
+    // the record containing the slot is the last one starting before it
+    auto record = std::prev(
+        std::upper_bound(records_.begin(), records_.end(), *it,
+                         [](std::uint32_t slot, const Record &r) {
+                           return slot < r.firstSlot;
+                         }));
+    lanelet::BasicPoint3d result;
+    decode(*record, *it - record->firstSlot + 1,
+           [&](lanelet::Id, const lanelet::BasicPoint3d &p) { result = p; });
+    return result;
+  }
+
+  const lanelet::AttributeMap *pointAttributes(lanelet::Id id) const {
+    auto it = pointAttributes_.find(id);
+    return it == pointAttributes_.end() ? nullptr : &it->second;
+  }
+
+  // 2D distance from (x, y) to the line string, decoded on the fly
+  double distance2d(lanelet::Id lsId, double x, double y) const {
+    using Point = planar::Point<double>;
+    Point query{x, y};
+    Point previous{};
+    bool first = true;
+    double best = std::numeric_limits<double>::infinity();
+    forEachPoint(lsId, [&](lanelet::Id, const lanelet::BasicPoint3d &p) {
+      Point current{p.x(), p.y()};
+      best = std::min(
+          best, first ? std::hypot(current.x - x, current.y - y)
+                      : std::sqrt(planar::squaredDistanceToSegment(
+                            query, previous, current)));
+      previous = current;
+      first = false;
+    });
+    return best;
+  }
+
+  // heap memory used by the tables. The map nodes are estimated (value plus
+  // the bookkeeping of libstdc++); memory owned by the attribute values
+  // themselves, e.g. long strings, is not included
+  size_t memoryUsage() const {
+    constexpr size_t TreeNodeOverhead = 4 * sizeof(void *);
+    constexpr size_t HashNodeOverhead = 2 * sizeof(void *);
+    return bytes_.capacity() * sizeof(std::uint8_t) +
+           pointIds_.capacity() * sizeof(lanelet::Id) +
+           records_.capacity() * sizeof(Record) +
+           tiles_.capacity() * sizeof(Tile) +
+           tileIds_.size() *
+               (sizeof(decltype(tileIds_)::value_type) + TreeNodeOverhead) +
+           lineStringIndex_.capacity() * sizeof(lineStringIndex_[0]) +
+           pointSlots_.capacity() * sizeof(std::uint32_t) +
+           pointAttributes_.bucket_count() * sizeof(void *) +
+           pointAttributes_.size() *
+               (sizeof(decltype(pointAttributes_)::value_type) +
+                HashNodeOverhead);
+  }
+
+  size_t numPoints() const { return pointSlots_.size(); }
+
+private:
+  struct Tile {
+    std::int32_t ix;
+    std::int32_t iy;
+  };
+  struct Record {
+    std::uint32_t tile;
+    std::uint32_t byteOffset;
+    std::uint32_t firstSlot; // into pointIds_, one slot per point
+    std::uint32_t size;
+  };
+
+  template <typename PointRange>
+  void add(lanelet::Id lsId, const PointRange &points) {
+    if (points.size() == 0)
+      return;
+    const auto &front = *points.begin();
+    Tile tile{static_cast<std::int32_t>(std::floor(front.x() / TileSize)),
+              static_cast<std::int32_t>(std::floor(front.y() / TileSize))};
+    // the slots of all points of the record have to be addressable
+    detail::checkedIndex(pointIds_.size() + points.size(), "points");
+    Record record{tileIndex(tile), detail::checkedIndex(bytes_.size(), "bytes"),
+                  detail::checkedIndex(pointIds_.size(), "points"),
+                  detail::checkedIndex(points.size(), "points")};
+    std::int64_t qx = detail::quantize(tile.ix * TileSize);
+    std::int64_t qy = detail::quantize(tile.iy * TileSize);
+    std::int64_t qz = 0;
+    for (const auto &p : points) {
+      std::int64_t x = detail::quantize(p.x());
+      std::int64_t y = detail::quantize(p.y());
+      std::int64_t z = detail::quantize(p.z());
+      detail::putVarint(bytes_, x - qx);
+      detail::putVarint(bytes_, y - qy);
+      detail::putVarint(bytes_, z - qz);
+      qx = x;
+      qy = y;
+      qz = z;
+      pointIds_.push_back(p.id());
+    }
+    if (lsId != lanelet::InvalId)
+      lineStringIndex_.emplace_back(
+          lsId, detail::checkedIndex(records_.size(), "line strings"));
+    records_.push_back(record);
+  }
+
+  std::uint32_t tileIndex(const Tile &tile) {
+    auto key = std::make_pair(tile.ix, tile.iy);
+    auto it = tileIds_.find(key);
+    if (it != tileIds_.end())
+      return it->second;
+    auto index = detail::checkedIndex(tiles_.size(), "tiles");
+    tiles_.push_back(tile);
+    tileIds_.emplace(key, index);
+    return index;
+  }
+
+  // decodes the first `count` points of the record
+  template <typename Func>
+  void decode(const Record &record, std::uint32_t count, Func &&f) const {
+    const Tile &tile = tiles_[record.tile];
+    const std::uint8_t *in = bytes_.data() + record.byteOffset;
+    std::int64_t qx = detail::quantize(tile.ix * TileSize);
+    std::int64_t qy = detail::quantize(tile.iy * TileSize);
+    std::int64_t qz = 0;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      qx += detail::getVarint(in);
+      qy += detail::getVarint(in);
+      qz += detail::getVarint(in);
+      f(pointIds_[record.firstSlot + i],
+        lanelet::BasicPoint3d(qx * Resolution, qy * Resolution,
+                              qz * Resolution));
+    }
+  }
+
+  std::vector<std::uint8_t> bytes_;
+  std::vector<lanelet::Id> pointIds_;
+  std::vector<Record> records_;
+  std::vector<Tile> tiles_;
+  std::map<std::pair<std::int32_t, std::int32_t>, std::uint32_t> tileIds_;
+  // (line string id, record), sorted
+  std::vector<std::pair<lanelet::Id, std::uint32_t>> lineStringIndex_;
+  // one slot per point id, sorted by pointIds_[slot]
+  std::vector<std::uint32_t> pointSlots_;
+  std::unordered_map<lanelet::Id, lanelet::AttributeMap> pointAttributes_;
+};
+
+} // namespace lanelet_tutorial::compact
+
+#endif // LANELET_TUTORIAL__COMPACT_MAP_HPP_
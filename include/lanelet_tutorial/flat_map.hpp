@@ -0,0 +1,197 @@
+#ifndef LANELET_TUTORIAL__FLAT_MAP_HPP_
+#define LANELET_TUTORIAL__FLAT_MAP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <lanelet_tutorial/span.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Flat, position independent layout of the geometry and ids of a map. The
+// buffer written by flat_map_writer.hpp can be mmap'ed or put in shared memory
+// and read in place by other processes, which only need this header and
+// span.hpp (no Lanelet2). All values are in host byte order.
+//
+// Layout: FlatMapHeader, then the arrays at the offsets given in the header
+// (each 8 byte aligned):
+//   points:       FlatPoint[pointCount], sorted by id
+//   lineStrings:  FlatLineString[lineStringCount], sorted by id
+//   pointIndices: uint32_t[pointIndexCount], points of the line strings
+//   lanelets:     FlatLanelet[laneletCount], sorted by id
+
+namespace lanelet_tutorial::flat_map {
+
+constexpr char Magic[8] = {'L', 'L', 'T', 'F', 'L', 'A', 'T', '\0'};
+// increment on every change of the structs below
+constexpr std::uint32_t Version = 1;
+
+struct FlatMapHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t headerSize;
+  std::uint64_t totalSize;
+  std::uint64_t pointCount;
+  std::uint64_t pointsOffset;
+  std::uint64_t lineStringCount;
+  std::uint64_t lineStringsOffset;
+  std::uint64_t pointIndexCount;
+  std::uint64_t pointIndicesOffset;
+  std::uint64_t laneletCount;
+  std::uint64_t laneletsOffset;
+};
+
+struct FlatPoint {
+  std::int64_t id;
+  double x;
+  double y;
+  double z;
+};
+
+struct FlatLineString {
+  std::int64_t id;
+  std::uint32_t firstPointIndex; // into pointIndices
+  std::uint32_t size;
+};
+
+struct FlatLanelet {
+  enum Flags : std::uint32_t { LeftInverted = 1U, RightInverted = 2U };
+  std::int64_t id;
+  std::uint32_t leftBound; // index into lineStrings
+  std::uint32_t rightBound;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<FlatMapHeader> &&
+                  std::is_trivially_copyable_v<FlatPoint> &&
+                  std::is_trivially_copyable_v<FlatLineString> &&
+                  std::is_trivially_copyable_v<FlatLanelet>,
+              "flat map records must be trivially copyable");
+static_assert(sizeof(FlatMapHeader) == 88 && sizeof(FlatPoint) == 32 &&
+                  sizeof(FlatLineString) == 16 && sizeof(FlatLanelet) == 24,
+              "flat map records must not change size within a version");
+
+// read-only view on a flat map buffer. The buffer has to outlive the view
+class FlatMapView {
+public:
+  // checks the header, that all arrays lie within the buffer and that all
+  // indices stored in them are in range, so that accessing the arrays through
+  // them needs no further checks. Throws std::invalid_argument otherwise
+  FlatMapView(const void *data, std::size_t size)
+      : data_(static_cast<const unsigned char *>(data)) {
+    if (size < sizeof(FlatMapHeader))
+      throw std::invalid_argument("Flat map buffer is too small");
+    std::memcpy(&header_, data_, sizeof(FlatMapHeader));
+    if (std::memcmp(header_.magic, Magic, sizeof(Magic)) != 0)
+      throw std::invalid_argument("Buffer is not a flat map");
+    if (header_.version != Version)
+      throw std::invalid_argument("Unsupported flat map version " +
+                                  std::to_string(header_.version));
+    if (header_.totalSize > size)
+      throw std::invalid_argument("Flat map buffer is truncated");
+    points_ = array<FlatPoint>(header_.pointsOffset, header_.pointCount);
+    lineStrings_ = array<FlatLineString>(header_.lineStringsOffset,
+                                         header_.lineStringCount);
+    pointIndices_ = array<std::uint32_t>(header_.pointIndicesOffset,
+                                         header_.pointIndexCount);
+    lanelets_ = array<FlatLanelet>(header_.laneletsOffset,
+                                   header_.laneletCount);
+    for (const auto &ls : lineStrings_)
+      if (std::uint64_t(ls.firstPointIndex) + ls.size > pointIndices_.size())
+        throw std::invalid_argument("Line string points are out of range");
+    for (auto index : pointIndices_)
+      if (index >= points_.size())
+        throw std::invalid_argument("Point index is out of range");
+    for (const auto &llt : lanelets_)
+      if (llt.leftBound >= lineStrings_.size() ||
+          llt.rightBound >= lineStrings_.size())
+        throw std::invalid_argument("Lanelet bound is out of range");
+  }
+
+  const FlatMapHeader &header() const { return header_; }
+  ConstSpan<FlatPoint> points() const { return points_; }
+  ConstSpan<FlatLineString> lineStrings() const { return lineStrings_; }
+  ConstSpan<FlatLanelet> lanelets() const { return lanelets_; }
+
+  // indices into points() of the points of the line string, which has to be
+  // one of lineStrings()
+  ConstSpan<std::uint32_t> pointIndices(const FlatLineString &ls) const {
+    return {pointIndices_.begin() + ls.firstPointIndex, ls.size};
+  }
+
+  const FlatPoint *findPoint(std::int64_t id) const {
+    return find(points_, id);
+  }
+  const FlatLineString *findLineString(std::int64_t id) const {
+    return find(lineStrings_, id);
+  }
+  const FlatLanelet *findLanelet(std::int64_t id) const {
+    return find(lanelets_, id);
+  }
+
+private:
+  template <typename T>
+  ConstSpan<T> array(std::uint64_t offset, std::uint64_t count) const {
+    if (offset % alignof(T) != 0 || offset > header_.totalSize ||
+        count > (header_.totalSize - offset) / sizeof(T))
+      throw std::invalid_argument("Flat map array is out of bounds");
+    return {reinterpret_cast<const T *>(data_ + offset),
+            static_cast<std::size_t>(count)};
+  }
+
+  template <typename T>
+  static const T *find(const ConstSpan<T> &records, std::int64_t id) {
+    auto it = std::lower_bound(
+        records.begin(), records.end(), id,
+        [](const T &record, std::int64_t value) { return record.id < value; });
+    return it != records.end() && it->id == id ? it : nullptr;
+  }
+
+  const unsigned char *data_;
+  FlatMapHeader header_{};
+  ConstSpan<FlatPoint> points_;
+  ConstSpan<FlatLineString> lineStrings_;
+  ConstSpan<std::uint32_t> pointIndices_;
+  ConstSpan<FlatLanelet> lanelets_;
+};
+
+// read-only mapping of a flat map file
+class MappedFlatMap {
+public:
+  explicit MappedFlatMap(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Failed to open " + path);
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+      ::close(fd);
+      throw std::runtime_error("Failed to stat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data_ == MAP_FAILED)
+      throw std::runtime_error("Failed to map " + path);
+  }
+  ~MappedFlatMap() { ::munmap(data_, size_); }
+  MappedFlatMap(const MappedFlatMap &) = delete;
+  MappedFlatMap &operator=(const MappedFlatMap &) = delete;
+
+  FlatMapView view() const { return FlatMapView(data_, size_); }
+
+private:
+  void *data_{nullptr};
+  std::size_t size_{0};
+};
+
+} // namespace lanelet_tutorial::flat_map
+
+#endif // LANELET_TUTORIAL__FLAT_MAP_HPP_
@@ -0,0 +1,131 @@
+#ifndef LANELET_TUTORIAL__FLAT_MAP_WRITER_HPP_
+#define LANELET_TUTORIAL__FLAT_MAP_WRITER_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet_tutorial/flat_map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lanelet_tutorial::flat_map {
+
+namespace detail {
+inline std::uint64_t align8(std::uint64_t offset) {
+  return (offset + 7) & ~7ULL;
+}
+
+template <typename T>
+void copyArray(std::vector<unsigned char> &buffer, std::uint64_t offset,
+               const std::vector<T> &values) {
+  if (!values.empty())
+    std::memcpy(buffer.data() + offset, values.data(),
+                values.size() * sizeof(T));
+}
+
+// indices in the schema are 32 bit
+inline std::uint32_t checkedIndex(std::size_t value, const char *what) {
+  if (value > std::numeric_limits<std::uint32_t>::max())
+    throw std::length_error(std::string("Too many ") + what +
+                            " for the flat map schema");
+  return static_cast<std::uint32_t>(value);
+}
+} // namespace detail
+
+// Converts the points, line strings and lanelets of the map into the layout
+// described in flat_map.hpp. Attributes and regulatory elements are not part
+// of the schema.
+inline std::vector<unsigned char>
+exportFlatMap(const lanelet::LaneletMap &map) {
+  std::vector<FlatPoint> points;
+  points.reserve(map.pointLayer.size());
+  for (const auto &p : map.pointLayer)
+    points.push_back({p.id(), p.x(), p.y(), p.z()});
+  auto byId = [](const auto &a, const auto &b) { return a.id < b.id; };
+  std::sort(points.begin(), points.end(), byId);
+  std::unordered_map<lanelet::Id, std::uint32_t> pointIndex;
+  pointIndex.reserve(points.size());
+  detail::checkedIndex(points.size(), "points");
+  for (std::uint32_t i = 0; i < points.size(); ++i)
+    pointIndex.emplace(points[i].id, i);
+
+  std::vector<lanelet::ConstLineString3d> lineStrings(
+      map.lineStringLayer.begin(), map.lineStringLayer.end());
+  std::sort(lineStrings.begin(), lineStrings.end(),
+            [](const auto &a, const auto &b) { return a.id() < b.id(); });
+  std::vector<FlatLineString> flatLineStrings;
+  std::vector<std::uint32_t> pointIndices;
+  std::unordered_map<lanelet::Id, std::uint32_t> lineStringIndex;
+  detail::checkedIndex(lineStrings.size(), "line strings");
+  flatLineStrings.reserve(lineStrings.size());
+  for (const auto &ls : lineStrings) {
+    lineStringIndex.emplace(ls.id(), flatLineStrings.size());
+    // the end of the line string has to be addressable as well
+    detail::checkedIndex(pointIndices.size() + ls.size(), "line string points");
+    flatLineStrings.push_back({ls.id(),
+                               static_cast<std::uint32_t>(pointIndices.size()),
+                               static_cast<std::uint32_t>(ls.size())});
+    for (const auto &p : ls)
+      pointIndices.push_back(pointIndex.at(p.id()));
+  }
+
+  std::vector<FlatLanelet> lanelets;
+  lanelets.reserve(map.laneletLayer.size());
+  for (const auto &llt : map.laneletLayer) {
+    FlatLanelet flat{llt.id(), lineStringIndex.at(llt.leftBound().id()),
+                     lineStringIndex.at(llt.rightBound().id()), 0, 0};
+    if (llt.leftBound().inverted())
+      flat.flags |= FlatLanelet::LeftInverted;
+    if (llt.rightBound().inverted())
+      flat.flags |= FlatLanelet::RightInverted;
+    lanelets.push_back(flat);
+  }
+  std::sort(lanelets.begin(), lanelets.end(), byId);
+
+  FlatMapHeader header{};
+  std::memcpy(header.magic, Magic, sizeof(Magic));
+  header.version = Version;
+  header.headerSize = sizeof(FlatMapHeader);
+  header.pointCount = points.size();
+  header.pointsOffset = detail::align8(sizeof(FlatMapHeader));
+  header.lineStringCount = flatLineStrings.size();
+  header.lineStringsOffset = detail::align8(
+      header.pointsOffset + points.size() * sizeof(FlatPoint));
+  header.pointIndexCount = pointIndices.size();
+  header.pointIndicesOffset = detail::align8(
+      header.lineStringsOffset +
+      flatLineStrings.size() * sizeof(FlatLineString));
+  header.laneletCount = lanelets.size();
+  header.laneletsOffset = detail::align8(
+      header.pointIndicesOffset + pointIndices.size() * sizeof(std::uint32_t));
+  header.totalSize =
+      header.laneletsOffset + lanelets.size() * sizeof(FlatLanelet);
+
+  std::vector<unsigned char> buffer(header.totalSize, 0);
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  detail::copyArray(buffer, header.pointsOffset, points);
+  detail::copyArray(buffer, header.lineStringsOffset, flatLineStrings);
+  detail::copyArray(buffer, header.pointIndicesOffset, pointIndices);
+  detail::copyArray(buffer, header.laneletsOffset, lanelets);
+  return buffer;
+}
+
+inline void writeFlatMap(const lanelet::LaneletMap &map,
+                         const std::string &path) {
+  auto buffer = exportFlatMap(map);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(buffer.data()),
+             static_cast<std::streamsize>(buffer.size()));
+  if (!file)
+    throw std::runtime_error("Failed to write " + path);
+}
+
+} // namespace lanelet_tutorial::flat_map
+
+#endif // LANELET_TUTORIAL__FLAT_MAP_WRITER_HPP_
@@ -0,0 +1,276 @@
+#ifndef LANELET_TUTORIAL__INSTRUMENTATION_HPP_
+#define LANELET_TUTORIAL__INSTRUMENTATION_HPP_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Scoped timers and counters for the map, routing and query calls of the
+// examples. Everything is recorded through the macros at the bottom, which
+// expand to nothing unless LANELET_TUTORIAL_ENABLE_INSTRUMENTATION is defined
+// (cmake -DLANELET_TUTORIAL_ENABLE_INSTRUMENTATION=ON).
+//
+// Operation and counter names must be string literals: they are keyed by
+// pointer, so recording neither allocates nor compares strings. Memory stays
+// bounded: histograms have fixed buckets and the trace keeps MaxTraceEvents.
+
+namespace lanelet_tutorial::instrumentation {
+
+// Log-scale histogram with four buckets per power of two, i.e. percentiles
+// are accurate to about 19%. Count, mean, min and max are exact.
+class Histogram {
+public:
+  void add(double value) {
+    ++buckets_[bucket(value)];
+    ++count_;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  void merge(const Histogram &other) {
+    for (size_t i = 0; i < NumBuckets; ++i)
+      buckets_[i] += other.buckets_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  std::uint64_t count() const { return count_; }
+  double mean() const { return count_ == 0 ? 0. : sum_ / count_; }
+  double max() const { return count_ == 0 ? 0. : max_; }
+
+  // p in [0, 1]; returns the geometric center of the bucket
+  double percentile(double p) const {
+    if (count_ == 0)
+      return 0.;
+    auto rank = static_cast<std::uint64_t>(p * static_cast<double>(count_ - 1));
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < NumBuckets; ++i) {
+      seen += buckets_[i];
+      if (seen > rank)
+        return std::clamp(center(i), min_, max_);
+    }
+    return max_;
+  }
+
+private:
+  static constexpr size_t NumBuckets = 128;
+  static constexpr int BucketsPerOctave = 4;
+  static constexpr int Offset = 32; // bucket 0 holds values below 2^-8
+
+  static size_t bucket(double value) {
+    if (!(value > 0.))
+      return 0;
+    int i = static_cast<int>(std::floor(BucketsPerOctave * std::log2(value))) +
+            Offset;
+    return static_cast<size_t>(std::clamp(i, 0, int(NumBuckets) - 1));
+  }
+  static double center(size_t i) {
+    return std::exp2((static_cast<double>(i) - Offset + 0.5) /
+                     BucketsPerOctave);
+  }
+
+  std::array<std::uint64_t, NumBuckets> buckets_{};
+  std::uint64_t count_{0};
+  double sum_{0.};
+  double min_{std::numeric_limits<double>::infinity()};
+  double max_{-std::numeric_limits<double>::infinity()};
+};
+
+class Registry {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // at most this many spans are kept for the trace
+  static constexpr size_t MaxTraceEvents = 100000;
+
+  static Registry &instance() {
+    static Registry registry;
+    return registry;
+  }
+
+  void recordSpan(const char *operation, Clock::time_point start,
+                  Clock::time_point end) {
+    double durationUs =
+        std::chrono::duration<double, std::micro>(end - start).count();
+    Operation &op = find(operation);
+    {
+      std::lock_guard<std::mutex> lock(op.mutex);
+      op.latencyUs.add(durationUs);
+    }
+    std::lock_guard<std::mutex> lock(eventsMutex_);
+    if (events_.size() < MaxTraceEvents)
+      events_.push_back({operation, micros(start), durationUs, threadIndex()});
+  }
+
+  // e.g. count("findNearest", "candidates", n)
+  void count(const char *operation, const char *counter, double value) {
+    Operation &op = find(operation);
+    std::lock_guard<std::mutex> lock(op.mutex);
+    op.counters[counter].add(value);
+  }
+
+  void writeSummary(std::ostream &os) const {
+    // the same name may have been recorded through different literals
+    std::map<std::string, Histogram> latencies;
+    std::map<std::string, std::map<std::string, Histogram>> counters;
+    {
+      std::lock_guard<std::mutex> lock(operationsMutex_);
+      for (const auto &entry : operations_) {
+        std::lock_guard<std::mutex> opLock(entry.second->mutex);
+        latencies[entry.first].merge(entry.second->latencyUs);
+        for (const auto &counter : entry.second->counters)
+          counters[entry.first][counter.first].merge(counter.second);
+      }
+    }
+    os << std::fixed << std::setprecision(1);
+    for (const auto &op : latencies) {
+      const auto &latency = op.second;
+      os << op.first << ": calls=" << latency.count()
+         << " mean=" << latency.mean() << "us p50~" << latency.percentile(0.5)
+         << "us p99~" << latency.percentile(0.99)
+         << "us max=" << latency.max() << "us\n";
+      for (const auto &counter : counters[op.first])
+        os << "  " << counter.first << ": n=" << counter.second.count()
+           << " mean=" << counter.second.mean()
+           << " p99~" << counter.second.percentile(0.99) << "\n";
+    }
+  }
+
+  // Chrome trace event format, open with chrome://tracing or Perfetto
+  void writeChromeTrace(std::ostream &os) const {
+    std::lock_guard<std::mutex> lock(eventsMutex_);
+    os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events_.size(); ++i) {
+      const auto &event = events_[i];
+      os << (i == 0 ? "" : ",") << "\n{\"name\":\"" << event.name
+         << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+         << ",\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs
+         << "}";
+    }
+    os << "\n]}\n";
+  }
+
+  // prints the summary to `os` and writes the trace to the file named by the
+  // LANELET_TUTORIAL_TRACE_FILE environment variable, if set
+  void dump(std::ostream &os) const {
+    writeSummary(os);
+    if (const char *path = std::getenv("LANELET_TUTORIAL_TRACE_FILE")) {
+      std::ofstream file(path);
+      writeChromeTrace(file);
+    }
+  }
+
+private:
+  struct Operation {
+    std::mutex mutex;
+    Histogram latencyUs;
+    std::map<const char *, Histogram> counters;
+  };
+  struct Event {
+    const char *name;
+    double startUs;
+    double durationUs;
+    size_t thread;
+  };
+
+  // Operations are never removed, so each thread caches the lookups and only
+  // takes the registry lock the first time it sees a name
+  Operation &find(const char *name) {
+    thread_local std::unordered_map<const char *, Operation *> cache;
+    auto cached = cache.find(name);
+    if (cached != cache.end())
+      return *cached->second;
+    std::lock_guard<std::mutex> lock(operationsMutex_);
+    auto &op = operations_[name];
+    if (!op)
+      op = std::make_unique<Operation>();
+    cache.emplace(name, op.get());
+    return *op;
+  }
+
+  static double micros(Clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t.time_since_epoch())
+        .count();
+  }
+
+  // called with eventsMutex_ held
+  size_t threadIndex() {
+    auto it = threads_.emplace(std::this_thread::get_id(), threads_.size());
+    return it.first->second;
+  }
+
+  mutable std::mutex operationsMutex_;
+  std::unordered_map<const char *, std::unique_ptr<Operation>> operations_;
+  mutable std::mutex eventsMutex_;
+  std::vector<Event> events_;
+  std::map<std::thread::id, size_t> threads_;
+};
+
+// records the lifetime of the scope as one span of `operation`. The name has
+// to outlive the registry, i.e. should be a string literal
+class ScopedTimer {
+public:
+  explicit ScopedTimer(const char *operation)
+      : operation_(operation), start_(Registry::Clock::now()) {}
+  ~ScopedTimer() {
+    Registry::instance().recordSpan(operation_, start_,
+                                    Registry::Clock::now());
+  }
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+  const char *operation_;
+  Registry::Clock::time_point start_;
+};
+
+// calls f() inside a LANELET_TUTORIAL_TRACE_SCOPE(operation) and returns its
+// result, e.g. `auto map = traced("lanelet::load", [&] { return load(...); })`
+template <typename Func>
+decltype(auto) traced(const char *operation, Func &&f) {
+#ifdef LANELET_TUTORIAL_ENABLE_INSTRUMENTATION
+  ScopedTimer timer(operation);
+#else
+  static_cast<void>(operation);
+#endif
+  return f();
+}
+
+} // namespace lanelet_tutorial::instrumentation
+
+#define LANELET_TUTORIAL_CONCAT_IMPL(a, b) a##b
+#define LANELET_TUTORIAL_CONCAT(a, b) LANELET_TUTORIAL_CONCAT_IMPL(a, b)
+
+#ifdef LANELET_TUTORIAL_ENABLE_INSTRUMENTATION
+#define LANELET_TUTORIAL_TRACE_SCOPE(operation)                                \
+  ::lanelet_tutorial::instrumentation::ScopedTimer LANELET_TUTORIAL_CONCAT(    \
+      laneletTutorialTrace, __LINE__)(operation)
+#define LANELET_TUTORIAL_COUNT(operation, counter, value)                      \
+  ::lanelet_tutorial::instrumentation::Registry::instance().count(             \
+      operation, counter, static_cast<double>(value))
+#define LANELET_TUTORIAL_TRACE_DUMP(os)                                        \
+  ::lanelet_tutorial::instrumentation::Registry::instance().dump(os)
+#else
+#define LANELET_TUTORIAL_TRACE_SCOPE(operation) static_cast<void>(0)
+#define LANELET_TUTORIAL_COUNT(operation, counter, value) static_cast<void>(0)
+#define LANELET_TUTORIAL_TRACE_DUMP(os) static_cast<void>(0)
+#endif
+
+#endif // LANELET_TUTORIAL__INSTRUMENTATION_HPP_
@@ -0,0 +1,200 @@
+#ifndef LANELET_TUTORIAL__LOOKAHEAD_HPP_
+#define LANELET_TUTORIAL__LOOKAHEAD_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_core/geometry/Lanelet.h>
+#include <lanelet2_core/geometry/LineString.h>
+#include <lanelet2_core/primitives/BasicRegulatoryElements.h>
+#include <lanelet2_routing/LaneletPath.h>
+#include <lanelet2_routing/RoutingGraph.h>
+#include <lanelet_tutorial/regulatory_element_index.hpp>
+#include <lanelet_tutorial/span.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Answers "what is ahead" along a LaneletPath without recomputing anything
+// per query. The lane ends (as in getRemainingLane()), the lanelet lengths and
+// the positions of the stop lines along the path are computed once when the
+// path is bound, the regulatory elements come from RegulatoryElementIndex;
+// afterwards the queries return views or precomputed values, and advance()
+// moves a cursor along the path.
+
+namespace lanelet_tutorial {
+
+class LaneletLookahead {
+public:
+  // lanelets of the path between two positions, like a LaneletSequence
+  // without the allocation
+  using Range = ConstSpan<lanelet::ConstLanelet>;
+
+  // something ahead on the path, with its distance from the vehicle, i.e.
+  // from the start of the current lanelet plus the offset passed to the query
+  template <typename T> struct Ahead {
+    T element;
+    lanelet::ConstLanelet lanelet;
+    double distance;
+  };
+
+  // the path must not be empty. The indices have to be built from the map of
+  // the graph; they are only used during construction
+  LaneletLookahead(
+      const lanelet::routing::RoutingGraph &graph,
+      const lanelet::routing::LaneletPath &path,
+      const RegulatoryElementIndex<lanelet::TrafficLight> &trafficLights,
+      const RegulatoryElementIndex<lanelet::RightOfWay> &rightOfWays)
+      : lanelets_(path.begin(), path.end()) {
+    const size_t n = lanelets_.size();
+    startDistances_.resize(n + 1, 0.);
+    for (size_t i = 0; i < n; ++i)
+      startDistances_[i + 1] =
+          startDistances_[i] + lanelet::geometry::length2d(lanelets_[i]);
+
+    laneEnds_.resize(n, n);
+    for (size_t i = n; i-- > 1;) {
+      auto relation = graph.routingRelation(lanelets_[i - 1], lanelets_[i]);
+      bool follows =
+          !!relation && *relation == lanelet::routing::RelationType::Successor;
+      laneEnds_[i - 1] = follows ? laneEnds_[i] : i;
+    }
+
+    stopLines_.resize(n);
+    stopLinePositions_.resize(n, 0.);
+    trafficLights_.resize(n);
+    trafficLightPositions_.resize(n, 0.);
+    for (size_t i = 0; i < n; ++i) {
+      for (auto &&light : trafficLights.of(lanelets_[i])) {
+        if (!trafficLights_[i]) {
+          trafficLights_[i] = light;
+          trafficLightPositions_[i] = position(i, light->stopLine());
+        }
+        if (!stopLines_[i])
+          stopLines_[i] = light->stopLine();
+      }
+      for (auto &&rightOfWay : rightOfWays.of(lanelets_[i]))
+        if (!stopLines_[i] && rightOfWay->getManeuver(lanelets_[i]) ==
+                                  lanelet::ManeuverType::Yield)
+          stopLines_[i] = rightOfWay->stopLine();
+      if (stopLines_[i])
+        stopLinePositions_[i] = position(i, stopLines_[i]);
+    }
+    nextStopLine_ = nextIndices(stopLines_);
+    nextTrafficLight_ = nextIndices(trafficLights_);
+  }
+
+  // moves the cursor forward to `current`. Amortized O(1) while driving along
+  // the path. Returns false (and keeps the cursor) if `current` is not ahead
+  // on the path, e.g. after leaving it; then the lookahead has to be rebound
+  bool advance(const lanelet::ConstLanelet &current) {
+    for (size_t i = cursor_; i < lanelets_.size(); ++i)
+      if (lanelets_[i] == current) {
+        cursor_ = i;
+        return true;
+      }
+    return false;
+  }
+
+  const lanelet::ConstLanelet &current() const { return lanelets_[cursor_]; }
+
+  // same lanelets as path.getRemainingLane() at the cursor
+  Range remainingLane() const {
+    return {lanelets_.data() + cursor_, lanelets_.data() + laneEnds_[cursor_]};
+  }
+
+  // lanelets from the cursor to the end of the path
+  Range remainingPath() const {
+    return {lanelets_.data() + cursor_, lanelets_.data() + lanelets_.size()};
+  }
+
+  // distance from the start of the current lanelet to the end of the lane,
+  // where the path requires a lane change. Infinite if it does not
+  double distanceToLaneChange() const {
+    size_t end = laneEnds_[cursor_];
+    if (end == lanelets_.size())
+      return std::numeric_limits<double>::infinity();
+    return startDistances_[end] - startDistances_[cursor_];
+  }
+
+  // `offset` is the distance the vehicle has driven along the current
+  // lanelet; stop lines behind it are skipped
+  lanelet::Optional<Ahead<lanelet::ConstLineString3d>>
+  nextStopLine(double offset = 0.) const {
+    size_t i = nextAhead(nextStopLine_, stopLinePositions_, offset);
+    if (i == lanelets_.size())
+      return {};
+    return Ahead<lanelet::ConstLineString3d>{
+        *stopLines_[i], lanelets_[i],
+        stopLinePositions_[i] - vehiclePosition(offset)};
+  }
+
+  // distance to the stop line of the traffic light, or to the end of its
+  // lanelet if it has none
+  lanelet::Optional<Ahead<lanelet::TrafficLight::ConstPtr>>
+  nextTrafficLight(double offset = 0.) const {
+    size_t i = nextAhead(nextTrafficLight_, trafficLightPositions_, offset);
+    if (i == lanelets_.size())
+      return {};
+    return Ahead<lanelet::TrafficLight::ConstPtr>{
+        trafficLights_[i], lanelets_[i],
+        trafficLightPositions_[i] - vehiclePosition(offset)};
+  }
+
+private:
+  double vehiclePosition(double offset) const {
+    return startDistances_[cursor_] + offset;
+  }
+
+  // position along the path where the vehicle stops for the line on lanelet
+  // i: the projection of the middle of the line onto the centerline, or the
+  // end of the lanelet if there is no line
+  double position(size_t i,
+                  const lanelet::Optional<lanelet::ConstLineString3d> &line) {
+    double length = startDistances_[i + 1] - startDistances_[i];
+    if (!line || line->empty())
+      return startDistances_[i + 1];
+    lanelet::BasicPoint2d middle =
+        (line->front().basicPoint() + line->back().basicPoint()).head<2>() / 2.;
+    double arcLength = lanelet::geometry::toArcCoordinates(
+                           lanelets_[i].centerline2d(), middle)
+                           .length;
+    return startDistances_[i] + std::clamp(arcLength, 0., length);
+  }
+
+  // index of the first element at or after the cursor that is not behind
+  // the vehicle, or size() if there is none
+  size_t nextAhead(const std::vector<size_t> &next,
+                   const std::vector<double> &positions, double offset) const {
+    size_t i = next[cursor_];
+    if (i == cursor_ && positions[i] < vehiclePosition(offset))
+      i = next[cursor_ + 1];
+    return i;
+  }
+
+  // for each position, the index of the first lanelet at or after it that
+  // has an element, or size() if there is none
+  template <typename T>
+  std::vector<size_t> nextIndices(const std::vector<T> &elements) const {
+    const size_t n = lanelets_.size();
+    std::vector<size_t> next(n + 1, n);
+    for (size_t i = n; i-- > 0;)
+      next[i] = elements[i] ? i : next[i + 1];
+    return next;
+  }
+
+  std::vector<lanelet::ConstLanelet> lanelets_;
+  std::vector<double> startDistances_;
+  std::vector<size_t> laneEnds_;
+  std::vector<lanelet::Optional<lanelet::ConstLineString3d>> stopLines_;
+  std::vector<double> stopLinePositions_; // along the path
+  std::vector<lanelet::TrafficLight::ConstPtr> trafficLights_;
+  std::vector<double> trafficLightPositions_;
+  std::vector<size_t> nextStopLine_;
+  std::vector<size_t> nextTrafficLight_;
+  size_t cursor_{0};
+};
+
+} // namespace lanelet_tutorial
+
+#endif // LANELET_TUTORIAL__LOOKAHEAD_HPP_
@@ -0,0 +1,272 @@
+#ifndef LANELET_TUTORIAL__MAP_SERVICE_HPP_
+#define LANELET_TUTORIAL__MAP_SERVICE_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_io/Io.h>
+#include <lanelet2_io/Projection.h>
+#include <lanelet2_routing/Route.h>
+#include <lanelet2_routing/RoutingGraph.h>
+#include <lanelet2_traffic_rules/TrafficRules.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Runs lanelet::load, RoutingGraph::build and route queries off the calling
+// thread. Results are returned as std::future, which can be polled from a
+// control loop or wrapped into an awaitable. A loaded map and its routing
+// graph are published as an immutable snapshot, so queries keep being served
+// from the previous map while a new one is built.
+
+namespace lanelet_tutorial::service {
+
+// fixed size pool of worker threads executing tasks in FIFO order
+class ThreadPool {
+public:
+  explicit ThreadPool(
+      size_t numThreads = std::max(1U, std::thread::hardware_concurrency())) {
+    for (size_t i = 0; i < numThreads; ++i)
+      threads_.emplace_back([this] { run(); });
+  }
+
+  // finishes the queued tasks before returning
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto &thread : threads_)
+      thread.join();
+  }
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+  }
+
+private:
+  void run() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty())
+          return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_{false};
+  std::vector<std::thread> threads_;
+};
+
+// thrown through the future of a request that was replaced by a newer
+// request on the same channel before it finished
+class RequestSuperseded : public std::runtime_error {
+public:
+  RequestSuperseded() : std::runtime_error("Request was superseded") {}
+};
+
+class MapService {
+public:
+  using Executor = std::function<void(std::function<void()>)>;
+
+  struct Snapshot {
+    lanelet::LaneletMapConstPtr map;
+    lanelet::routing::RoutingGraphConstPtr graph;
+    lanelet::ErrorMessages loadErrors;
+    std::uint64_t version{0};
+  };
+  using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+  // the result keeps the snapshot it was computed on alive
+  struct RouteResult {
+    SnapshotPtr snapshot;
+    lanelet::Optional<lanelet::routing::Route> route;
+  };
+  struct PathResult {
+    SnapshotPtr snapshot;
+    lanelet::Optional<lanelet::routing::LaneletPath> path;
+  };
+
+  // runs the work on its own thread pool
+  MapService(lanelet::traffic_rules::TrafficRulesPtr trafficRules,
+             std::shared_ptr<const lanelet::Projector> projector,
+             size_t numThreads = 2)
+      : MapService(std::move(trafficRules), std::move(projector),
+                   Executor()) {
+    pool_ = std::make_unique<ThreadPool>(numThreads);
+    executor_ = [pool = pool_.get()](std::function<void()> task) {
+      pool->post(std::move(task));
+    };
+  }
+
+  // runs the work on `executor`, which has to outlive the service's tasks
+  MapService(lanelet::traffic_rules::TrafficRulesPtr trafficRules,
+             std::shared_ptr<const lanelet::Projector> projector,
+             Executor executor)
+      : state_(std::make_shared<State>()), executor_(std::move(executor)) {
+    state_->trafficRules = std::move(trafficRules);
+    state_->projector = std::move(projector);
+  }
+
+  // the currently published map and graph, nullptr before the first load
+  SnapshotPtr snapshot() const { return std::atomic_load(&state_->snapshot); }
+
+  // loads the map and builds its routing graph, then publishes them. A load
+  // that finishes after a newer load was requested is not published. Once
+  // published, the future returns the snapshot even if a newer load is
+  // requested right after
+  std::future<SnapshotPtr> loadAsync(std::string path) {
+    return submit<SnapshotPtr>("load", [path = std::move(path)](
+                                           State &state,
+                                           const IsCurrent &isCurrent) {
+      auto snapshot = std::make_shared<Snapshot>();
+      {
+        // projectors are not thread safe (e.g. MGRSProjector remembers the
+        // grid it projected into), so loads only overlap in graph building
+        std::lock_guard<std::mutex> lock(state.loadMutex);
+        if (!isCurrent())
+          throw RequestSuperseded();
+        snapshot->map =
+            lanelet::load(path, *state.projector, &snapshot->loadErrors);
+      }
+      if (!isCurrent())
+        throw RequestSuperseded();
+      snapshot->graph = lanelet::routing::RoutingGraph::build(
+          *snapshot->map, *state.trafficRules);
+      std::lock_guard<std::mutex> lock(state.publishMutex);
+      if (!isCurrent())
+        throw RequestSuperseded();
+      snapshot->version = ++state.version;
+      SnapshotPtr published = snapshot;
+      std::atomic_store(&state.snapshot, published);
+      return published;
+    });
+  }
+
+  // Queries run on the snapshot that is current when they are requested. A
+  // new request on the same channel supersedes the pending one
+  std::future<RouteResult> routeAsync(lanelet::Id from, lanelet::Id to,
+                                      const std::string &channel = "route") {
+    return submit<RouteResult>(
+        channel, [snapshot = snapshot(), from, to](
+                     State &, const IsCurrent &isCurrent) {
+          RouteResult result{requireSnapshot(snapshot), {}};
+          const auto &layer = result.snapshot->map->laneletLayer;
+          result.route = result.snapshot->graph->getRoute(layer.get(from),
+                                                          layer.get(to), 0);
+          if (!isCurrent())
+            throw RequestSuperseded();
+          return result;
+        });
+  }
+
+  std::future<PathResult>
+  shortestPathAsync(lanelet::Id from, lanelet::Id to,
+                    const std::string &channel = "shortestPath") {
+    return submit<PathResult>(
+        channel, [snapshot = snapshot(), from, to](
+                     State &, const IsCurrent &isCurrent) {
+          PathResult result{requireSnapshot(snapshot), {}};
+          const auto &layer = result.snapshot->map->laneletLayer;
+          result.path = result.snapshot->graph->shortestPath(layer.get(from),
+                                                             layer.get(to), 0);
+          if (!isCurrent())
+            throw RequestSuperseded();
+          return result;
+        });
+  }
+
+  // supersedes the pending request of the channel ("load" for loadAsync)
+  void cancel(const std::string &channel) { ++*generation(channel); }
+
+private:
+  using Generation = std::shared_ptr<std::atomic<std::uint64_t>>;
+  using IsCurrent = std::function<bool()>;
+
+  struct State {
+    lanelet::traffic_rules::TrafficRulesPtr trafficRules;
+    std::shared_ptr<const lanelet::Projector> projector;
+    std::mutex loadMutex; // guards the use of projector
+    SnapshotPtr snapshot; // only accessed through std::atomic_load/store
+    std::mutex publishMutex;
+    std::uint64_t version{0};
+    std::mutex generationsMutex;
+    std::unordered_map<std::string, Generation> generations;
+  };
+
+  static SnapshotPtr requireSnapshot(const SnapshotPtr &snapshot) {
+    if (!snapshot)
+      throw std::logic_error("No map has been loaded yet");
+    return snapshot;
+  }
+
+  Generation generation(const std::string &channel) {
+    std::lock_guard<std::mutex> lock(state_->generationsMutex);
+    auto &counter = state_->generations[channel];
+    if (!counter)
+      counter = std::make_shared<std::atomic<std::uint64_t>>(0);
+    return counter;
+  }
+
+  // Runs work(state, isCurrent) on the executor. The request is skipped if it
+  // is superseded before it starts. The routing calls themselves cannot be
+  // interrupted, so work has to check isCurrent() once they return and throw
+  // RequestSuperseded to drop the result. Only work knows when its result
+  // takes effect (a load is published under publishMutex), so the final
+  // check is left to it.
+  template <typename ResultT, typename Func>
+  std::future<ResultT> submit(const std::string &channel, Func work) {
+    Generation counter = generation(channel);
+    std::uint64_t request = ++*counter;
+    auto promise = std::make_shared<std::promise<ResultT>>();
+    auto future = promise->get_future();
+    executor_([state = state_, counter, request, promise,
+               work = std::move(work)] {
+      IsCurrent isCurrent = [&counter, request] { return *counter == request; };
+      try {
+        if (!isCurrent())
+          throw RequestSuperseded();
+        promise->set_value(work(*state, isCurrent));
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+      }
+    });
+    return future;
+  }
+
+  std::shared_ptr<State> state_;
+  Executor executor_;
+  // declared last so that it is joined before the other members go away
+  std::unique_ptr<ThreadPool> pool_;
+};
+
+} // namespace lanelet_tutorial::service
+
+#endif // LANELET_TUTORIAL__MAP_SERVICE_HPP_
@@ -0,0 +1,449 @@
+#ifndef LANELET_TUTORIAL__MAP_VALIDATION_HPP_
+#define LANELET_TUTORIAL__MAP_VALIDATION_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_core/geometry/Lanelet.h>
+#include <lanelet2_routing/RoutingGraph.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Consistency checks for a map and its routing graph, run in parallel over
+// the lanelets. The result is a list of issues that can be printed as text or
+// JSON, e.g. to gate the deployment of a map release.
+//
+// Checks:
+//   degenerate_geometry    bounds with less than two points, repeated points,
+//                          lanelets shorter than MinLength
+//   disconnected_lanelet   no predecessor, successor or neighbour
+//   bound_overlap          overlap with a lanelet beside it
+//   inconsistent_lane_change
+//                          lane change allowed in only one direction across a
+//                          symmetric (solid or dashed) line
+//   unreachable_region     lanelets that cannot be reached from, or cannot
+//                          get back to, the largest strongly connected part
+//                          of the road network
+//
+// Lanelets that are not in the routing graph, e.g. crosswalks in a graph for
+// vehicles, only get the geometry checks.
+
+namespace lanelet_tutorial::validation {
+
+enum class Severity { Warning, Error };
+
+struct Issue {
+  Severity severity;
+  std::string check;
+  lanelet::Id id; // primitive the issue was found on
+  std::string message;
+};
+
+struct Report {
+  std::vector<Issue> issues;
+
+  size_t count(Severity severity) const {
+    return static_cast<size_t>(
+        std::count_if(issues.begin(), issues.end(), [severity](const auto &i) {
+          return i.severity == severity;
+        }));
+  }
+  bool passed() const { return count(Severity::Error) == 0; }
+
+  void writeText(std::ostream &os) const {
+    for (const auto &issue : issues)
+      os << (issue.severity == Severity::Error ? "error" : "warning") << ": "
+         << issue.check << " [" << issue.id << "] " << issue.message << "\n";
+    os << count(Severity::Error) << " errors, " << count(Severity::Warning)
+       << " warnings\n";
+  }
+
+  void writeJson(std::ostream &os) const {
+    // messages contain attribute values from the map, so escape everything
+    // JSON does not allow in a string
+    auto quoted = [](const std::string &s) {
+      std::string result = "\"";
+      for (char c : s) {
+        switch (c) {
+        case '"':
+          result += "\\\"";
+          break;
+        case '\\':
+          result += "\\\\";
+          break;
+        case '\n':
+          result += "\\n";
+          break;
+        case '\r':
+          result += "\\r";
+          break;
+        case '\t':
+          result += "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[7];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                          static_cast<unsigned>(static_cast<unsigned char>(c)));
+            result += escaped;
+          } else {
+            result += c;
+          }
+        }
+      }
+      return result + "\"";
+    };
+    os << "{\"passed\":" << (passed() ? "true" : "false") << ",\"issues\":[";
+    for (size_t i = 0; i < issues.size(); ++i) {
+      const auto &issue = issues[i];
+      os << (i == 0 ? "" : ",") << "\n{\"severity\":"
+         << (issue.severity == Severity::Error ? "\"error\"" : "\"warning\"")
+         << ",\"check\":" << quoted(issue.check) << ",\"id\":" << issue.id
+         << ",\"message\":" << quoted(issue.message) << "}";
+    }
+    os << "\n]}\n";
+  }
+};
+
+class MapValidator {
+public:
+  static constexpr double MinLength = 0.1;         // [m]
+  static constexpr double MinPointDistance = 1e-3; // [m]
+
+  // the routing graph has to be built from `map`. Only const member functions
+  // of the map primitives and the graph are called from the worker threads
+  MapValidator(const lanelet::LaneletMap &map,
+               const lanelet::routing::RoutingGraph &graph)
+      : graph_(graph), lanelets_(map.laneletLayer.begin(),
+                                 map.laneletLayer.end()) {
+    std::sort(lanelets_.begin(), lanelets_.end(),
+              [](const auto &a, const auto &b) { return a.id() < b.id(); });
+    auto passable = graph_.passableSubmap();
+    routable_.reserve(lanelets_.size());
+    for (size_t i = 0; i < lanelets_.size(); ++i) {
+      indices_.emplace(lanelets_[i].id(), i);
+      routable_.push_back(passable->laneletLayer.exists(lanelets_[i].id()));
+    }
+  }
+
+  Report run(size_t numThreads = std::max(
+                 1U, std::thread::hardware_concurrency())) const {
+    numThreads = std::min(numThreads, std::max<size_t>(lanelets_.size(), 1));
+    std::vector<std::future<ChunkResult>> chunks;
+    size_t chunkSize = (lanelets_.size() + numThreads - 1) / numThreads;
+    for (size_t first = 0; first < lanelets_.size(); first += chunkSize)
+      chunks.push_back(std::async(
+          std::launch::async, [this, first, chunkSize] {
+            return checkChunk(first,
+                              std::min(first + chunkSize, lanelets_.size()));
+          }));
+
+    Report report;
+    std::vector<std::pair<size_t, size_t>> edges;
+    std::vector<bool> isolated(lanelets_.size(), false);
+    for (auto &chunk : chunks) {
+      ChunkResult result = chunk.get();
+      std::move(result.issues.begin(), result.issues.end(),
+                std::back_inserter(report.issues));
+      edges.insert(edges.end(), result.edges.begin(), result.edges.end());
+      for (size_t i : result.isolated)
+        isolated[i] = true;
+    }
+    checkUnreachableRegions(edges, isolated, report);
+
+    // errors first, then by check and id
+    std::sort(report.issues.begin(), report.issues.end(),
+              [](const Issue &a, const Issue &b) {
+                return std::tie(b.severity, a.check, a.id) <
+                       std::tie(a.severity, b.check, b.id);
+              });
+    return report;
+  }
+
+private:
+  struct ChunkResult {
+    std::vector<Issue> issues;
+    // (from, to) where `to` can be driven to from `from`, indices into
+    // lanelets_
+    std::vector<std::pair<size_t, size_t>> edges;
+    // lanelets reported as disconnected_lanelet
+    std::vector<size_t> isolated;
+  };
+
+  ChunkResult checkChunk(size_t first, size_t last) const {
+    ChunkResult result;
+    for (size_t i = first; i < last; ++i) {
+      const auto &llt = lanelets_[i];
+      checkGeometry(llt, result.issues);
+      if (!routable_[i])
+        continue;
+      checkConnections(i, result);
+      checkLeftNeighbour(llt, result.issues);
+    }
+    return result;
+  }
+
+  static void checkGeometry(const lanelet::ConstLanelet &llt,
+                            std::vector<Issue> &issues) {
+    for (const auto &bound : {llt.leftBound2d(), llt.rightBound2d()}) {
+      if (bound.size() < 2) {
+        issues.push_back({Severity::Error, "degenerate_geometry", llt.id(),
+                          "bound " + std::to_string(bound.id()) +
+                              " has less than two points"});
+        continue;
+      }
+      for (size_t i = 1; i < bound.size(); ++i)
+        if ((bound[i].basicPoint() - bound[i - 1].basicPoint()).norm() <
+            MinPointDistance)
+          issues.push_back({Severity::Warning, "degenerate_geometry", llt.id(),
+                            "bound " + std::to_string(bound.id()) +
+                                " repeats point " +
+                                std::to_string(bound[i].id())});
+    }
+    // the centerline is computed lazily and cached, which is not thread
+    // safe, so measure the left bound instead
+    double length = 0.;
+    auto left = llt.leftBound2d();
+    for (size_t i = 1; i < left.size(); ++i)
+      length += (left[i].basicPoint() - left[i - 1].basicPoint()).norm();
+    if (left.size() >= 2 && length < MinLength)
+      issues.push_back({Severity::Warning, "degenerate_geometry", llt.id(),
+                        "lanelet is only " + std::to_string(length) +
+                            " m long"});
+  }
+
+  void checkConnections(size_t index, ChunkResult &result) const {
+    const auto &llt = lanelets_[index];
+    auto addEdge = [&](const lanelet::ConstLanelet &other) {
+      auto it = indices_.find(other.id());
+      if (it != indices_.end())
+        result.edges.emplace_back(index, it->second);
+    };
+    // successors and the lanelets a lane change is allowed to
+    auto following = graph_.following(llt, true);
+    for (const auto &next : following)
+      addEdge(next);
+    if (following.empty() && graph_.previous(llt, true).empty() &&
+        graph_.besides(llt).size() <= 1) {
+      result.issues.push_back(
+          {Severity::Warning, "disconnected_lanelet", llt.id(),
+           "lanelet has no predecessor, successor or neighbour"});
+      result.isolated.push_back(index);
+    }
+  }
+
+  void checkLeftNeighbour(const lanelet::ConstLanelet &llt,
+                          std::vector<Issue> &issues) const {
+    auto left = graph_.left(llt);
+    auto neighbour = left ? left : graph_.adjacentLeft(llt);
+    if (!neighbour)
+      return;
+    if (lanelet::geometry::overlaps2d(llt, *neighbour))
+      issues.push_back({Severity::Error, "bound_overlap", llt.id(),
+                        "overlaps its left neighbour " +
+                            std::to_string(neighbour->id())});
+
+    // only lines that look the same from both sides are checked; for
+    // solid_dashed or dashed_solid a one-sided lane change is intended
+    if (llt.leftBound() != neighbour->rightBound())
+      return;
+    std::string subtype = llt.leftBound().attributeOr(
+        lanelet::AttributeName::Subtype, "");
+    if (subtype != lanelet::AttributeValueString::Solid &&
+        subtype != lanelet::AttributeValueString::Dashed)
+      return;
+    auto back = graph_.right(*neighbour);
+    bool toLeft = !!left;
+    bool toRight = !!back && *back == llt;
+    if (toLeft != toRight)
+      issues.push_back({Severity::Error, "inconsistent_lane_change", llt.id(),
+                        "lane change across " + subtype + " line " +
+                            std::to_string(llt.leftBound().id()) + " to " +
+                            std::to_string(neighbour->id()) + " is allowed " +
+                            (toLeft ? "only to the left" : "only back")});
+  }
+
+  // The main road network is the largest strongly connected component of
+  // the directed graph, i.e. the largest set of lanelets that can all reach
+  // each other. Every other routable lanelet either cannot be reached from
+  // it, cannot get back to it (dead end) or both. Lanelets with the same
+  // problem that are connected to each other are reported as one region.
+  void checkUnreachableRegions(
+      const std::vector<std::pair<size_t, size_t>> &edges,
+      const std::vector<bool> &isolated, Report &report) const {
+    const size_t n = lanelets_.size();
+    auto forward = adjacency(edges, false);
+    auto backward = adjacency(edges, true);
+    std::vector<size_t> component = stronglyConnectedComponents(forward);
+    std::vector<size_t> sizes(n, 0);
+    for (size_t i = 0; i < n; ++i)
+      if (routable_[i])
+        ++sizes[component[i]];
+    auto mainComponent = static_cast<size_t>(
+        std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+    if (n == 0 || sizes[mainComponent] == 0)
+      return;
+
+    enum Problem : unsigned { NotReachable = 1U, NoWayBack = 2U };
+    std::vector<unsigned> problems(n, NotReachable | NoWayBack);
+    for (size_t i = 0; i < n; ++i)
+      if (!routable_[i])
+        problems[i] = 0;
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < n; ++i)
+      if (routable_[i] && component[i] == mainComponent)
+        roots.push_back(i);
+    for (size_t i : reachable(forward, roots))
+      problems[i] &= ~unsigned(NotReachable);
+    for (size_t i : reachable(backward, roots))
+      problems[i] &= ~unsigned(NoWayBack);
+
+    // group connected lanelets with the same problem
+    std::vector<size_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](size_t i) {
+      while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+      return i;
+    };
+    for (const auto &edge : edges)
+      if (problems[edge.first] != 0 &&
+          problems[edge.first] == problems[edge.second])
+        parent[find(edge.first)] = find(edge.second);
+    std::map<size_t, std::vector<size_t>> regions;
+    for (size_t i = 0; i < n; ++i)
+      if (problems[i] != 0)
+        regions[find(i)].push_back(i);
+
+    for (const auto &region : regions) {
+      const auto &members = region.second;
+      if (members.size() == 1 && isolated[members[0]])
+        continue; // already reported as disconnected_lanelet
+      unsigned problem = problems[members[0]];
+      std::string what =
+          problem == NotReachable ? "cannot be reached from"
+          : problem == NoWayBack  ? "cannot get back to"
+                                  : "is not connected to";
+      std::string ids;
+      for (size_t member : members)
+        ids += (ids.empty() ? "" : " ") +
+               std::to_string(lanelets_[member].id());
+      report.issues.push_back(
+          {Severity::Warning, "unreachable_region", lanelets_[members[0]].id(),
+           "region of " + std::to_string(members.size()) + " lanelets " +
+               what + " the main road network: " + ids});
+    }
+  }
+
+  // compressed adjacency lists: the targets of i are
+  // targets[offsets[i]] ... targets[offsets[i + 1] - 1]
+  struct Adjacency {
+    std::vector<size_t> offsets;
+    std::vector<size_t> targets;
+  };
+
+  Adjacency adjacency(const std::vector<std::pair<size_t, size_t>> &edges,
+                      bool reversed) const {
+    Adjacency result;
+    result.offsets.assign(lanelets_.size() + 1, 0);
+    for (const auto &edge : edges)
+      ++result.offsets[(reversed ? edge.second : edge.first) + 1];
+    std::partial_sum(result.offsets.begin(), result.offsets.end(),
+                     result.offsets.begin());
+    result.targets.resize(edges.size());
+    std::vector<size_t> next(result.offsets.begin(), result.offsets.end() - 1);
+    for (const auto &edge : edges)
+      result.targets[next[reversed ? edge.second : edge.first]++] =
+          reversed ? edge.first : edge.second;
+    return result;
+  }
+
+  // component index of each node (Tarjan's algorithm, without recursion so
+  // that long roads do not overflow the stack)
+  static std::vector<size_t>
+  stronglyConnectedComponents(const Adjacency &graph) {
+    const size_t n = graph.offsets.size() - 1;
+    constexpr size_t Unvisited = std::numeric_limits<size_t>::max();
+    std::vector<size_t> order(n, Unvisited);
+    std::vector<size_t> low(n, 0);
+    std::vector<size_t> component(n, Unvisited);
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, size_t>> calls; // (node, next edge)
+    size_t counter = 0;
+    size_t components = 0;
+    for (size_t root = 0; root < n; ++root) {
+      if (order[root] != Unvisited)
+        continue;
+      order[root] = low[root] = counter++;
+      stack.push_back(root);
+      calls.emplace_back(root, graph.offsets[root]);
+      while (!calls.empty()) {
+        size_t v = calls.back().first;
+        size_t &edge = calls.back().second;
+        if (edge < graph.offsets[v + 1]) {
+          size_t w = graph.targets[edge++];
+          if (order[w] == Unvisited) {
+            order[w] = low[w] = counter++;
+            stack.push_back(w);
+            calls.emplace_back(w, graph.offsets[w]);
+          } else if (component[w] == Unvisited) { // w is on the stack
+            low[v] = std::min(low[v], order[w]);
+          }
+          continue;
+        }
+        if (low[v] == order[v]) {
+          size_t w = Unvisited;
+          do {
+            w = stack.back();
+            stack.pop_back();
+            component[w] = components;
+          } while (w != v);
+          ++components;
+        }
+        calls.pop_back();
+        if (!calls.empty()) {
+          size_t u = calls.back().first;
+          low[u] = std::min(low[u], low[v]);
+        }
+      }
+    }
+    return component;
+  }
+
+  static std::vector<size_t> reachable(const Adjacency &graph,
+                                       const std::vector<size_t> &roots) {
+    std::vector<bool> seen(graph.offsets.size() - 1, false);
+    std::vector<size_t> result(roots);
+    for (size_t root : roots)
+      seen[root] = true;
+    for (size_t i = 0; i < result.size(); ++i)
+      for (size_t e = graph.offsets[result[i]];
+           e < graph.offsets[result[i] + 1]; ++e)
+        if (!seen[graph.targets[e]]) {
+          seen[graph.targets[e]] = true;
+          result.push_back(graph.targets[e]);
+        }
+    return result;
+  }
+
+  const lanelet::routing::RoutingGraph &graph_;
+  std::vector<lanelet::ConstLanelet> lanelets_; // sorted by id
+  std::unordered_map<lanelet::Id, size_t> indices_;
+  std::vector<bool> routable_; // in the routing graph
+};
+
+} // namespace lanelet_tutorial::validation
+
+#endif // LANELET_TUTORIAL__MAP_VALIDATION_HPP_
@@ -0,0 +1,267 @@
+#ifndef LANELET_TUTORIAL__PLANAR_GEOMETRY_HPP_
+#define LANELET_TUTORIAL__PLANAR_GEOMETRY_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// 2D-only geometry for maps whose queries ignore z. Line strings and polygons
+// keep their points as packed (x, y) pairs instead of Lanelet2's 3D points, so
+// there is no to2D()/toHybrid() conversion and kernels touch half the memory.
+// The scalar type is a template parameter: with float, coordinates are stored
+// as offsets from a tile origin to keep the precision at map scale.
+// Define LANELET_TUTORIAL_PLANAR_USE_FLOAT to make float the default.
+
+namespace lanelet_tutorial::planar {
+
+#ifdef LANELET_TUTORIAL_PLANAR_USE_FLOAT
+using DefaultScalar = float;
+#else
+using DefaultScalar = double;
+#endif
+
+template <typename Scalar> struct Point {
+  static_assert(std::is_floating_point_v<Scalar>);
+  Scalar x;
+  Scalar y;
+};
+
+// global position that the stored coordinates are relative to
+struct TileOrigin {
+  double x{0.};
+  double y{0.};
+
+  template <typename Scalar> Point<Scalar> toLocal(double gx, double gy) const {
+    return {static_cast<Scalar>(gx - x), static_cast<Scalar>(gy - y)};
+  }
+  template <typename Scalar> void toGlobal(const Point<Scalar> &p, double &gx,
+                                           double &gy) const {
+    gx = x + p.x;
+    gy = y + p.y;
+  }
+};
+
+// squared distance from p to the segment a-b
+template <typename Scalar>
+Scalar squaredDistanceToSegment(const Point<Scalar> &p, const Point<Scalar> &a,
+                                const Point<Scalar> &b) {
+  Scalar dx = b.x - a.x;
+  Scalar dy = b.y - a.y;
+  Scalar lengthSq = dx * dx + dy * dy;
+  Scalar t = lengthSq > Scalar(0)
+                 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSq
+                 : Scalar(0);
+  t = std::clamp(t, Scalar(0), Scalar(1));
+  Scalar ex = a.x + t * dx - p.x;
+  Scalar ey = a.y + t * dy - p.y;
+  return ex * ex + ey * ey;
+}
+
+namespace detail {
+template <typename Scalar>
+Scalar cross(const Point<Scalar> &o, const Point<Scalar> &a,
+             const Point<Scalar> &b) {
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+template <typename Scalar>
+bool onSegment(const Point<Scalar> &a, const Point<Scalar> &b,
+               const Point<Scalar> &p) {
+  return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) &&
+         std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+} // namespace detail
+
+template <typename Scalar>
+bool intersects(const Point<Scalar> &a1, const Point<Scalar> &a2,
+                const Point<Scalar> &b1, const Point<Scalar> &b2) {
+  Scalar d1 = detail::cross(b1, b2, a1);
+  Scalar d2 = detail::cross(b1, b2, a2);
+  Scalar d3 = detail::cross(a1, a2, b1);
+  Scalar d4 = detail::cross(a1, a2, b2);
+  if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+      ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+    return true;
+  return (d1 == 0 && detail::onSegment(b1, b2, a1)) ||
+         (d2 == 0 && detail::onSegment(b1, b2, a2)) ||
+         (d3 == 0 && detail::onSegment(a1, a2, b1)) ||
+         (d4 == 0 && detail::onSegment(a1, a2, b2));
+}
+
+// packed points relative to an origin, shared by LineString and Polygon
+template <typename Scalar> class PointSequence {
+public:
+  void push_back(double gx, double gy) {
+    points_.push_back(origin_.toLocal<Scalar>(gx, gy));
+  }
+
+  const TileOrigin &origin() const { return origin_; }
+  const std::vector<Point<Scalar>> &points() const { return points_; }
+  size_t size() const { return points_.size(); }
+
+  Point<Scalar> local(double gx, double gy) const {
+    return origin_.toLocal<Scalar>(gx, gy);
+  }
+
+  // the points relative to another origin
+  std::vector<Point<Scalar>> pointsIn(const TileOrigin &origin) const {
+    std::vector<Point<Scalar>> result;
+    result.reserve(points_.size());
+    double gx = 0.;
+    double gy = 0.;
+    for (const auto &p : points_) {
+      origin_.toGlobal(p, gx, gy);
+      result.push_back(origin.toLocal<Scalar>(gx, gy));
+    }
+    return result;
+  }
+
+protected:
+  PointSequence() = default;
+  explicit PointSequence(TileOrigin origin) : origin_(origin) {}
+
+  template <typename PointsT> void assign(const PointsT &points) {
+    points_.reserve(points.size());
+    for (const auto &p : points)
+      push_back(p.x(), p.y());
+  }
+
+  TileOrigin origin_;
+  std::vector<Point<Scalar>> points_;
+};
+
+// open polyline
+template <typename Scalar = DefaultScalar>
+class LineString : public PointSequence<Scalar> {
+public:
+  LineString() = default;
+  explicit LineString(TileOrigin origin) : PointSequence<Scalar>(origin) {}
+
+  // from anything iterable whose points have x() and y(), e.g. a
+  // lanelet::ConstLineString3d. z is dropped
+  template <typename LineStringT>
+  static LineString from(const LineStringT &ls, TileOrigin origin = {}) {
+    LineString result(origin);
+    result.assign(ls);
+    return result;
+  }
+};
+
+// closed ring; the last point connects back to the first one. Deliberately
+// not a LineString, whose functions would ignore the closing edge
+template <typename Scalar = DefaultScalar>
+class Polygon : public PointSequence<Scalar> {
+public:
+  Polygon() = default;
+  explicit Polygon(TileOrigin origin) : PointSequence<Scalar>(origin) {}
+
+  template <typename PolygonT>
+  static Polygon from(const PolygonT &poly, TileOrigin origin = {}) {
+    Polygon result(origin);
+    result.assign(poly);
+    return result;
+  }
+};
+
+// absolute area (shoelace formula)
+template <typename Scalar> double area(const Polygon<Scalar> &poly) {
+  const auto &pts = poly.points();
+  double twiceArea = 0.;
+  for (size_t i = 0, j = pts.size() - 1; i < pts.size(); j = i++)
+    twiceArea += static_cast<double>(pts[j].x) * pts[i].y -
+                 static_cast<double>(pts[i].x) * pts[j].y;
+  return std::abs(twiceArea) / 2.;
+}
+
+// whether the global position (x, y) lies inside the polygon (even-odd rule)
+template <typename Scalar>
+bool within(const Polygon<Scalar> &poly, double x, double y) {
+  const auto &pts = poly.points();
+  Point<Scalar> p = poly.local(x, y);
+  bool inside = false;
+  for (size_t i = 0, j = pts.size() - 1; i < pts.size(); j = i++)
+    if ((pts[i].y > p.y) != (pts[j].y > p.y) &&
+        p.x < (pts[j].x - pts[i].x) * (p.y - pts[i].y) /
+                      (pts[j].y - pts[i].y) +
+                  pts[i].x)
+      inside = !inside;
+  return inside;
+}
+
+namespace detail {
+// sum of the segment lengths, including pts.back() -> pts.front() if closed
+template <typename Scalar>
+double length(const std::vector<Point<Scalar>> &pts, bool closed) {
+  double result = 0.;
+  for (size_t i = 1; i < pts.size(); ++i)
+    result += std::hypot(pts[i].x - pts[i - 1].x, pts[i].y - pts[i - 1].y);
+  if (closed && pts.size() > 2)
+    result += std::hypot(pts.front().x - pts.back().x,
+                         pts.front().y - pts.back().y);
+  return result;
+}
+
+template <typename Scalar>
+double distance(const std::vector<Point<Scalar>> &pts, const Point<Scalar> &p,
+                bool closed) {
+  if (pts.empty())
+    return std::numeric_limits<double>::infinity();
+  if (pts.size() == 1)
+    return std::hypot(pts[0].x - p.x, pts[0].y - p.y);
+  Scalar best = std::numeric_limits<Scalar>::max();
+  for (size_t i = 1; i < pts.size(); ++i)
+    best = std::min(best, squaredDistanceToSegment(p, pts[i - 1], pts[i]));
+  if (closed && pts.size() > 2)
+    best = std::min(best, squaredDistanceToSegment(p, pts.back(), pts[0]));
+  return std::sqrt(static_cast<double>(best));
+}
+} // namespace detail
+
+template <typename Scalar>
+double length(const LineString<Scalar> &ls) {
+  return detail::length(ls.points(), false);
+}
+
+// length of the boundary, including the closing edge
+template <typename Scalar> double perimeter(const Polygon<Scalar> &poly) {
+  return detail::length(poly.points(), true);
+}
+
+// distance of the global position (x, y) to the polyline
+template <typename Scalar>
+double distance(const LineString<Scalar> &ls, double x, double y) {
+  return detail::distance(ls.points(), ls.local(x, y), false);
+}
+
+// distance of the global position (x, y) to the polygon; 0 inside, like
+// lanelet::geometry::distance2d
+template <typename Scalar>
+double distance(const Polygon<Scalar> &poly, double x, double y) {
+  if (within(poly, x, y))
+    return 0.;
+  return detail::distance(poly.points(), poly.local(x, y), true);
+}
+
+template <typename Scalar>
+bool intersects(const LineString<Scalar> &a, const LineString<Scalar> &b) {
+  const auto &pa = a.points();
+  // compare in the frame of a
+  bool sameOrigin =
+      a.origin().x == b.origin().x && a.origin().y == b.origin().y;
+  std::vector<Point<Scalar>> moved;
+  if (!sameOrigin)
+    moved = b.pointsIn(a.origin());
+  const auto &pb = sameOrigin ? b.points() : moved;
+  for (size_t i = 1; i < pa.size(); ++i)
+    for (size_t j = 1; j < pb.size(); ++j)
+      if (intersects(pa[i - 1], pa[i], pb[j - 1], pb[j]))
+        return true;
+  return false;
+}
+
+} // namespace lanelet_tutorial::planar
+
+#endif // LANELET_TUTORIAL__PLANAR_GEOMETRY_HPP_
@@ -0,0 +1,92 @@
+#ifndef LANELET_TUTORIAL__POOL_ALLOCATOR_HPP_
+#define LANELET_TUTORIAL__POOL_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace lanelet_tutorial {
+
+// Hands out fixed size blocks from large chunks. Freed blocks are reused, but
+// chunks are only released at exit, which suits data that lives as long as
+// the map.
+template <size_t BlockSize> class FixedBlockPool {
+public:
+  static FixedBlockPool &instance() {
+    static FixedBlockPool pool;
+    return pool;
+  }
+
+  void *allocate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!freeList_)
+      grow();
+    Node *node = freeList_;
+    freeList_ = node->next;
+    return node;
+  }
+
+  void deallocate(void *p) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node *node = static_cast<Node *>(p);
+    node->next = freeList_;
+    freeList_ = node;
+  }
+
+private:
+  union Node {
+    Node *next;
+    alignas(std::max_align_t) unsigned char storage[BlockSize];
+  };
+  static constexpr size_t BlocksPerChunk = 1024;
+
+  void grow() {
+    chunks_.emplace_back(new Node[BlocksPerChunk]);
+    Node *chunk = chunks_.back().get();
+    for (size_t i = 0; i < BlocksPerChunk; ++i) {
+      chunk[i].next = freeList_;
+      freeList_ = &chunk[i];
+    }
+  }
+
+  std::vector<std::unique_ptr<Node[]>> chunks_;
+  Node *freeList_{nullptr};
+  std::mutex mutex_;
+};
+
+// allocator for std::allocate_shared: single objects (the shared_ptr control
+// block together with its payload) come from the pool
+template <typename T> struct PoolAllocator {
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "over-aligned types are not supported");
+  using value_type = T;
+
+  PoolAllocator() = default;
+  template <typename U> PoolAllocator(const PoolAllocator<U> &) {}
+
+  T *allocate(size_t n) {
+    if (n != 1)
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    return static_cast<T *>(FixedBlockPool<sizeof(T)>::instance().allocate());
+  }
+  void deallocate(T *p, size_t n) {
+    if (n != 1) {
+      ::operator delete(p);
+      return;
+    }
+    FixedBlockPool<sizeof(T)>::instance().deallocate(p);
+  }
+
+  template <typename U> bool operator==(const PoolAllocator<U> &) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const PoolAllocator<U> &) const {
+    return false;
+  }
+};
+
+} // namespace lanelet_tutorial
+
+#endif // LANELET_TUTORIAL__POOL_ALLOCATOR_HPP_
@@ -0,0 +1,135 @@
+#ifndef LANELET_TUTORIAL__REGULATORY_ELEMENT_FACTORY_HPP_
+#define LANELET_TUTORIAL__REGULATORY_ELEMENT_FACTORY_HPP_
+
+#include <lanelet2_core/Exceptions.h>
+#include <lanelet2_core/primitives/Lanelet.h>
+#include <lanelet2_core/primitives/RegulatoryElement.h>
+#include <lanelet_tutorial/pool_allocator.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace lanelet_tutorial {
+
+using RegulatoryElementTypeId = std::uint16_t;
+constexpr RegulatoryElementTypeId InvalidRegulatoryElementTypeId =
+    std::numeric_limits<RegulatoryElementTypeId>::max();
+
+// dense id of T, assigned when T is registered
+template <class T> struct RegisteredTypeId {
+  static inline RegulatoryElementTypeId value = InvalidRegulatoryElementTypeId;
+};
+
+// RegulatoryElementFactory::create() looks the rule name up in a string map
+// for every element. Here each registered type gets a dense integer id, so the
+// name is resolved at most once and creation is an index into a table. The
+// RegulatoryElementData is taken from a pool instead of the heap.
+//
+// Types are registered during static initialization (see
+// RegisterFastRegulatoryElement); afterwards the factory is only read and
+// create() may be called from several threads.
+class FastRegulatoryElementFactory {
+public:
+  using Factory = lanelet::RegulatoryElementPtr (*)(
+      const lanelet::RegulatoryElementDataPtr &);
+
+  static FastRegulatoryElementFactory &instance() {
+    static FastRegulatoryElementFactory factory;
+    return factory;
+  }
+
+  template <class T> RegulatoryElementTypeId add(Factory factory) {
+    auto &id = RegisteredTypeId<T>::value;
+    if (id != InvalidRegulatoryElementTypeId)
+      return id;
+    id = static_cast<RegulatoryElementTypeId>(factories_.size());
+    factories_.push_back(factory);
+    typeInfos_.push_back(&typeid(T));
+    ruleNames_.emplace_back(T::RuleName);
+    ids_.emplace(T::RuleName, id);
+    return id;
+  }
+
+  // resolve a rule name, e.g. once per "subtype" value while parsing a map
+  RegulatoryElementTypeId typeIdOf(const std::string &ruleName) const {
+    auto it = ids_.find(ruleName);
+    return it == ids_.end() ? InvalidRegulatoryElementTypeId : it->second;
+  }
+
+  // type id of the dynamic type of the element, no matter which factory
+  // created it. InvalidRegulatoryElementTypeId if that type is not registered
+  RegulatoryElementTypeId
+  typeIdOf(const lanelet::RegulatoryElement &regelem) const {
+    const std::type_info *type = &typeid(regelem);
+    for (size_t i = 0; i < typeInfos_.size(); ++i)
+      if (typeInfos_[i] == type)
+        return static_cast<RegulatoryElementTypeId>(i);
+    return InvalidRegulatoryElementTypeId;
+  }
+
+  lanelet::RegulatoryElementPtr
+  create(RegulatoryElementTypeId type, lanelet::Id id,
+         const lanelet::RuleParameterMap &parameters,
+         const lanelet::AttributeMap &attributes = {}) const {
+    if (type >= factories_.size())
+      throw lanelet::InvalidInputError(
+          "Regulatory element type is not registered");
+    auto data = std::allocate_shared<lanelet::RegulatoryElementData>(
+        PoolAllocator<lanelet::RegulatoryElementData>(), id, parameters,
+        attributes);
+    data->attributes[lanelet::AttributeName::Subtype] = ruleNames_[type];
+    return factories_[type](data);
+  }
+
+  template <class T>
+  std::shared_ptr<T>
+  create(lanelet::Id id, const lanelet::RuleParameterMap &parameters,
+         const lanelet::AttributeMap &attributes = {}) const {
+    return std::static_pointer_cast<T>(
+        create(RegisteredTypeId<T>::value, id, parameters, attributes));
+  }
+
+private:
+  std::vector<Factory> factories_;
+  std::vector<const std::type_info *> typeInfos_;
+  std::vector<std::string> ruleNames_;
+  std::unordered_map<std::string, RegulatoryElementTypeId> ids_;
+};
+
+// counterpart of RegisterRegulatoryElement<T> for FastRegulatoryElementFactory
+template <class T> class RegisterFastRegulatoryElement {
+public:
+  RegisterFastRegulatoryElement() {
+    FastRegulatoryElementFactory::instance().add<T>(
+        [](const lanelet::RegulatoryElementDataPtr &data)
+            -> lanelet::RegulatoryElementPtr {
+          return std::shared_ptr<T>(new T(data));
+        });
+  }
+};
+
+// calls f for the regulatory elements of the lanelet whose dynamic type is
+// exactly T, whichever factory created them (e.g. lanelet::load()). Unlike
+// regulatoryElementsAs<T>() this does not walk the class hierarchy with
+// dynamic_cast and allocates nothing: the check compares the address of the
+// element's type_info, which the element carries through its vtable, with
+// the one of T. Note the different semantics: elements of types derived from
+// T do not match. If T's type_info is duplicated across shared libraries
+// (e.g. T defined in a plugin loaded with RTLD_LOCAL) elements from the other
+// library are skipped; they are never mistaken for another type.
+template <class T, typename LaneletT, typename Func>
+void forEachRegulatoryElementOf(const LaneletT &lanelet, Func &&f) {
+  const std::type_info *type = &typeid(T);
+  for (const auto &regelem : lanelet.constData()->regulatoryElements)
+    if (&typeid(*regelem) == type)
+      f(static_cast<const T &>(*regelem));
+}
+
+} // namespace lanelet_tutorial
+
+#endif // LANELET_TUTORIAL__REGULATORY_ELEMENT_FACTORY_HPP_
@@ -0,0 +1,91 @@
+#ifndef LANELET_TUTORIAL__REGULATORY_ELEMENT_INDEX_HPP_
+#define LANELET_TUTORIAL__REGULATORY_ELEMENT_INDEX_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet_tutorial/span.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lanelet_tutorial {
+
+// regulatoryElementsAs<T>() and findUsages() dynamic_cast every element and
+// return a new vector on each call. This index does the casts once per map and
+// keeps the results of each type in one flat array (lanelet id -> elements,
+// line string id -> elements using it), so that lookups only return views.
+// The index has to be rebuilt if the map is modified.
+template <typename RegElemT> class RegulatoryElementIndex {
+public:
+  using ElementPtr = std::shared_ptr<const RegElemT>;
+
+  explicit RegulatoryElementIndex(const lanelet::LaneletMap &map) {
+    std::vector<std::pair<lanelet::Id, ElementPtr>> byLanelet;
+    for (const auto &llt : map.laneletLayer)
+      for (const auto &regelem : llt.template regulatoryElementsAs<RegElemT>())
+        byLanelet.emplace_back(llt.id(), regelem);
+    byLanelet_.build(std::move(byLanelet));
+
+    std::vector<std::pair<lanelet::Id, ElementPtr>> byLineString;
+    for (const auto &regelem : map.regulatoryElementLayer) {
+      auto typed = std::dynamic_pointer_cast<const RegElemT>(regelem);
+      if (!typed)
+        continue;
+      for (const auto &role : typed->getParameters())
+        for (const auto &param : role.second)
+          if (const auto *ls = boost::get<lanelet::ConstLineString3d>(&param))
+            byLineString.emplace_back(ls->id(), typed);
+    }
+    byLineString_.build(std::move(byLineString));
+  }
+
+  // equivalent of lanelet.regulatoryElementsAs<RegElemT>()
+  ConstSpan<ElementPtr> of(const lanelet::ConstLanelet &lanelet) const {
+    return byLanelet_.get(lanelet.id());
+  }
+
+  // equivalent of regulatoryElementLayer.findUsages(ls) restricted to RegElemT
+  ConstSpan<ElementPtr>
+  usingLineString(const lanelet::ConstLineString3d &ls) const {
+    return byLineString_.get(ls.id());
+  }
+
+private:
+  struct Table {
+    std::vector<ElementPtr> elements;
+    std::unordered_map<lanelet::Id, std::pair<size_t, size_t>> ranges;
+
+    void build(std::vector<std::pair<lanelet::Id, ElementPtr>> &&pairs) {
+      std::sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first ||
+               (a.first == b.first && a.second.get() < b.second.get());
+      });
+      pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+      elements.reserve(pairs.size());
+      for (auto &&pair : pairs) {
+        auto it = ranges.emplace(pair.first, std::make_pair(elements.size(),
+                                                            elements.size()))
+                      .first;
+        elements.push_back(std::move(pair.second));
+        it->second.second = elements.size();
+      }
+    }
+
+    ConstSpan<ElementPtr> get(lanelet::Id id) const {
+      auto it = ranges.find(id);
+      if (it == ranges.end())
+        return {};
+      return {elements.data() + it->second.first,
+              elements.data() + it->second.second};
+    }
+  };
+
+  Table byLanelet_;
+  Table byLineString_;
+};
+
+} // namespace lanelet_tutorial
+
+#endif // LANELET_TUTORIAL__REGULATORY_ELEMENT_INDEX_HPP_
@@ -0,0 +1,204 @@
+#ifndef LANELET_TUTORIAL__ROUTE_CORRIDOR_HPP_
+#define LANELET_TUTORIAL__ROUTE_CORRIDOR_HPP_
+
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_core/geometry/LineString.h>
+#include <lanelet2_routing/Route.h>
+#include <lanelet2_routing/RoutingGraph.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace lanelet_tutorial {
+
+// One side of a route corridor with its arc length index. The points are
+// stored contiguously but may form several pieces: where the lane count
+// changes, the next bound does not start where the previous one ended, and
+// joining them would cut across the road. Gaps between pieces do not add to
+// the arc length.
+struct CorridorBoundary {
+  // points closer than this are merged
+  static constexpr double MergeDistance = 1e-3;
+
+  std::vector<lanelet::BasicPoint2d> points;
+  std::vector<double> arcLengths; // arc length at each point
+  std::vector<bool> pieceStarts;  // whether a point starts a new piece
+
+  // continues the last piece if ls starts where it ends, otherwise starts a
+  // new piece. Returns the index of the first point of ls
+  size_t append(const lanelet::ConstLineString2d &ls) {
+    size_t first = points.size();
+    bool newPiece = true;
+    if (!points.empty() && ls.size() > 0 &&
+        (ls.front().basicPoint() - points.back()).norm() < MergeDistance) {
+      first = points.size() - 1;
+      newPiece = false;
+    }
+    for (auto &&p : ls) {
+      lanelet::BasicPoint2d point = p.basicPoint();
+      if (newPiece) {
+        arcLengths.push_back(points.empty() ? 0. : arcLengths.back());
+        points.push_back(point);
+        pieceStarts.push_back(true);
+        newPiece = false;
+        continue;
+      }
+      double step = (point - points.back()).norm();
+      if (step < MergeDistance)
+        continue;
+      arcLengths.push_back(arcLengths.back() + step);
+      points.push_back(point);
+      pieceStarts.push_back(false);
+    }
+    return first;
+  }
+
+  double length() const { return arcLengths.empty() ? 0. : arcLengths.back(); }
+
+  // whether points[i] and points[i + 1] are connected
+  bool isSegment(size_t i) const { return !pieceStarts[i + 1]; }
+
+  // point at arc length s, clamped to the boundary. Within a gap between two
+  // pieces this is the start of the next piece. The boundary must not be
+  // empty
+  lanelet::BasicPoint2d interpolate(double s) const {
+    auto it = std::upper_bound(arcLengths.begin(), arcLengths.end(), s);
+    if (it == arcLengths.begin())
+      return points.front();
+    if (it == arcLengths.end())
+      return points.back();
+    size_t i = static_cast<size_t>(it - arcLengths.begin());
+    double ratio =
+        (s - arcLengths[i - 1]) / (arcLengths[i] - arcLengths[i - 1]);
+    return points[i - 1] + ratio * (points[i] - points[i - 1]);
+  }
+
+  // projects p onto the segments starting at [first, last). Returns the arc
+  // length of the projection and the signed distance (positive if p is on the
+  // left). The distance is infinite if there is no segment in the range
+  lanelet::ArcCoordinates project(const lanelet::BasicPoint2d &p, size_t first,
+                                  size_t last) const {
+    lanelet::ArcCoordinates best{0., std::numeric_limits<double>::infinity()};
+    if (points.size() < 2)
+      return best;
+    last = std::min(last, points.size() - 1);
+    for (size_t i = first; i < last; ++i) {
+      if (!isSegment(i))
+        continue;
+      lanelet::BasicPoint2d segment = points[i + 1] - points[i];
+      lanelet::BasicPoint2d toP = p - points[i];
+      double length = arcLengths[i + 1] - arcLengths[i];
+      double t = std::clamp(segment.dot(toP) / (length * length), 0., 1.);
+      double cross = segment.x() * toP.y() - segment.y() * toP.x();
+      double distance = (toP - t * segment).norm();
+      if (distance < std::abs(best.distance)) {
+        best.length = arcLengths[i] + t * length;
+        best.distance = cross < 0 ? -distance : distance;
+      }
+    }
+    return best;
+  }
+};
+
+// The drivable corridor of a route around the lane starting at `start`: the
+// left bound of the leftmost and the right bound of the rightmost lanelet
+// beside each lanelet of the lane, merged into two boundaries. It is built
+// once per route; advance() only moves the start of the corridor, so nothing
+// has to be rebuilt while driving along the route.
+class RouteCorridor {
+public:
+  // number of slices ahead of the current one that are used for lookups
+  static constexpr size_t SearchSlices = 3;
+
+  // position of a point relative to both boundaries: the arc length along
+  // each boundary from the start of the route and the signed distance to it,
+  // positive on the left
+  struct Projection {
+    lanelet::ArcCoordinates left;
+    lanelet::ArcCoordinates right;
+  };
+
+  RouteCorridor(const lanelet::routing::RoutingGraph &graph,
+                const lanelet::routing::Route &route,
+                const lanelet::ConstLanelet &start) {
+    for (auto &&llt : route.fullLane(start)) {
+      Slice slice;
+      for (auto &&beside : graph.besides(llt))
+        if (route.contains(beside))
+          slice.lanelets.push_back(beside);
+      slice.left = left_.append(
+          lanelet::utils::to2D(slice.lanelets.front().leftBound()));
+      slice.right = right_.append(
+          lanelet::utils::to2D(slice.lanelets.back().rightBound()));
+      slices_.push_back(std::move(slice));
+    }
+  }
+
+  // moves the start of the corridor to the slice containing `current`.
+  // Returns false if `current` is not ahead on the corridor (e.g. the vehicle
+  // left the route), in this case the corridor has to be built again
+  bool advance(const lanelet::ConstLanelet &current) {
+    for (size_t i = first_; i < slices_.size(); ++i) {
+      const auto &lanelets = slices_[i].lanelets;
+      if (std::find(lanelets.begin(), lanelets.end(), current) !=
+          lanelets.end()) {
+        first_ = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const CorridorBoundary &left() const { return left_; }
+  const CorridorBoundary &right() const { return right_; }
+  // index of the first point of the remaining corridor
+  size_t leftBegin() const { return slices_[first_].left; }
+  size_t rightBegin() const { return slices_[first_].right; }
+
+  // projects p onto both boundaries. Only looks at the next few slices of
+  // the corridor, so p should be close to the current position
+  Projection project(const lanelet::BasicPoint2d &p) const {
+    if (slices_.empty())
+      return {left_.project(p, 0, 0), right_.project(p, 0, 0)};
+    size_t last = std::min(first_ + SearchSlices, slices_.size());
+    size_t leftEnd =
+        last < slices_.size() ? slices_[last].left : left_.points.size();
+    size_t rightEnd =
+        last < slices_.size() ? slices_[last].right : right_.points.size();
+    return {left_.project(p, leftBegin(), leftEnd),
+            right_.project(p, rightBegin(), rightEnd)};
+  }
+
+  // signed distances of p to the left and right boundary, positive if p is
+  // on the left
+  std::pair<double, double>
+  lateralDistances(const lanelet::BasicPoint2d &p) const {
+    Projection projection = project(p);
+    return {projection.left.distance, projection.right.distance};
+  }
+
+  bool contains(const lanelet::BasicPoint2d &p) const {
+    auto distances = lateralDistances(p);
+    return distances.first <= 0. && distances.second >= 0.;
+  }
+
+private:
+  struct Slice {
+    lanelet::ConstLanelets lanelets; // sorted from left to right
+    size_t left{};
+    size_t right{};
+  };
+
+  CorridorBoundary left_;
+  CorridorBoundary right_;
+  std::vector<Slice> slices_;
+  size_t first_{};
+};
+
+} // namespace lanelet_tutorial
+
+#endif // LANELET_TUTORIAL__ROUTE_CORRIDOR_HPP_
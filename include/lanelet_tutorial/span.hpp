@@ -0,0 +1,30 @@
+#ifndef LANELET_TUTORIAL__SPAN_HPP_
+#define LANELET_TUTORIAL__SPAN_HPP_
+
+#include <cstddef>
+
+namespace lanelet_tutorial {
+
+// non-owning view of a contiguous range, like std::span in C++20
+template <typename T> class ConstSpan {
+public:
+  ConstSpan() = default;
+  ConstSpan(const T *first, const T *last) : first_(first), last_(last) {}
+  ConstSpan(const T *first, std::size_t size)
+      : first_(first), last_(first + size) {}
+  const T *begin() const { return first_; }
+  const T *end() const { return last_; }
+  std::size_t size() const { return static_cast<std::size_t>(last_ - first_); }
+  bool empty() const { return first_ == last_; }
+  const T &front() const { return *first_; }
+  const T &back() const { return *(last_ - 1); }
+  const T &operator[](std::size_t i) const { return first_[i]; }
+
+private:
+  const T *first_{nullptr};
+  const T *last_{nullptr};
+};
+
+} // namespace lanelet_tutorial
+
+#endif // LANELET_TUTORIAL__SPAN_HPP_
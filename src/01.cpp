@@ -8,6 +8,7 @@
 #include <lanelet2_core/primitives/Polygon.h>
 #include <lanelet2_core/primitives/BasicRegulatoryElements.h>
 #include <lanelet2_core/utility/Units.h>
+#include <lanelet_tutorial/planar_geometry.hpp>
 
 #include <iostream>
 #include <iomanip>
@@ -282,6 +283,17 @@ void part6Geometry() {
   auto ar = geometry::area(utils::to2D(poly));
   cout << ar << endl; // 2
 
+  // if z is never needed, keep packed 2D copies and skip the conversions
+  namespace planar = lanelet_tutorial::planar;
+  auto lsPlanar = planar::LineString<>::from(ls);
+  auto polyPlanar = planar::Polygon<>::from(poly);
+  cout << planar::distance(lsPlanar, point.x(), point.y()) << endl; // 2
+  cout << planar::area(polyPlanar) << endl;                          // 2
+  // float storage relative to a tile origin for large map coordinates
+  auto lsPlanarFloat =
+      planar::LineString<float>::from(ls, planar::TileOrigin{1., 2.});
+  cout << planar::distance(lsPlanarFloat, point.x(), point.y()) << endl; // 2
+
   BasicPoint3d pProj = geometry::project(ls, point);
   cout << "pProj: x = " << pProj.x() << ", y = " << pProj.y()
        << ", z = " << pProj.z() << endl;
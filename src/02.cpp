@@ -1,8 +1,14 @@
 #include <lanelet2_core/LaneletMap.h>
 #include <lanelet2_core/primitives/BasicRegulatoryElements.h>
 #include <lanelet2_core/primitives/Lanelet.h>
+#include <lanelet_tutorial/regulatory_element_factory.hpp>
 
 using namespace lanelet;
+using lanelet_tutorial::FastRegulatoryElementFactory;
+using lanelet_tutorial::forEachRegulatoryElementOf;
+using lanelet_tutorial::RegisterFastRegulatoryElement;
+using lanelet_tutorial::RegisteredTypeId;
+using lanelet_tutorial::RegulatoryElementTypeId;
 
 void part1BasicRegulatoryElements();
 void part3AddingNewRegulatoryElements();
@@ -90,9 +96,17 @@ class LightsOn : public RegulatoryElement {
 public:
   static constexpr char RuleName[] = "lights_on";
 
-  // return the line where we are supposed to stop
+  // return the line where we are supposed to stop.
+  // getParameters<T>() would build a new vector for every call, so read the
+  // parameter directly from the underlying data
   ConstLineString3d fromWhere() const {
-    return getParameters<ConstLineString3d>(RoleName::RefLine).front();
+    const auto &parameters = constData()->parameters;
+    auto refLines = parameters.find(RoleName::RefLine);
+    if (refLines != parameters.end())
+      for (const auto &param : refLines->second)
+        if (const auto *ls = boost::get<LineString3d>(&param))
+          return *ls;
+    throw InvalidInputError("lights_on has no ref_line line string");
   }
 
 private:
@@ -101,6 +115,7 @@ private:
     parameters().insert({RoleNameString::RefLine, {fromWhere}});
   }
   friend class RegisterRegulatoryElement<LightsOn>;
+  friend class RegisterFastRegulatoryElement<LightsOn>;
   explicit LightsOn(const RegulatoryElementDataPtr &data)
       : RegulatoryElement(data) {}
 };
@@ -108,6 +123,8 @@ private:
 namespace {
 // this does the work of registration
 RegisterRegulatoryElement<LightsOn> reg;
+// and for the integer keyed factory
+RegisterFastRegulatoryElement<LightsOn> fastReg;
 } // namespace
 
 void part3AddingNewRegulatoryElements() {
@@ -118,4 +135,23 @@ void part3AddingNewRegulatoryElements() {
   Lanelet lanelet = getLanelet();
   lanelet.addRegulatoryElement(regelem);
   assert(!lanelet.regulatoryElementsAs<LightsOn>().empty());
+  assert(lanelet.regulatoryElementsAs<LightsOn>().front()->fromWhere() ==
+         fromWhere);
+
+  // resolve the rule name once, afterwards creation is a table lookup
+  auto &factory = FastRegulatoryElementFactory::instance();
+  RegulatoryElementTypeId lightsOnType = factory.typeIdOf("lights_on");
+  assert(lightsOnType == RegisteredTypeId<LightsOn>::value);
+  lanelet.addRegulatoryElement(
+      factory.create(lightsOnType, utils::getId(), rules));
+  lanelet.addRegulatoryElement(
+      factory.create<LightsOn>(utils::getId(), rules));
+
+  // the first element was created by RegulatoryElementFactory, as it would be
+  // by lanelet::load(), and matches as well
+  assert(factory.typeIdOf(*regelem) == lightsOnType);
+  size_t nLightsOn = 0;
+  forEachRegulatoryElementOf<LightsOn>(
+      lanelet, [&nLightsOn](const LightsOn &) { ++nLightsOn; });
+  assert(nLightsOn == 3);
 }
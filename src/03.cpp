@@ -4,15 +4,25 @@
 #include <lanelet2_core/geometry/Point.h>
 #include <lanelet2_core/primitives/Lanelet.h>
 #include <lanelet2_core/primitives/BasicRegulatoryElements.h>
+#include <lanelet_tutorial/instrumentation.hpp>
+#include <lanelet_tutorial/regulatory_element_index.hpp>
+
+#include <iostream>
+#include <vector>
 
 using namespace lanelet;
+using lanelet_tutorial::RegulatoryElementIndex;
+using lanelet_tutorial::instrumentation::traced;
 
 void part1AboutLaneletMaps();
 void part3QueryingInformation();
+void part4RegulatoryElementIndex();
 
 int main() {
   part1AboutLaneletMaps();
   part3QueryingInformation();
+  part4RegulatoryElementIndex();
+  LANELET_TUTORIAL_TRACE_DUMP(std::cout);
   return 0;
 }
 
@@ -83,30 +93,62 @@ void part3QueryingInformation() {
   // we can find primitives with geometriacl queris. Becuase internally all
   // primitives are stored as bounding boxes, these queries only return the
   // primitives with respect to their bounding box
-  Lanelets lanelets = laneletMap.laneletLayer.nearest(
-      BasicPoint2d(0, 0), 1 /*the number of nn-search query*/);
+  Lanelets lanelets = traced("LaneletLayer::nearest", [&] {
+    return laneletMap.laneletLayer.nearest(
+        BasicPoint2d(0, 0), 1 /*the number of nn-search query*/);
+  });
   assert(!lanelets.empty());
 
   // to get the actually closest lanelets use this utility function
   std::vector<std::pair<double, Lanelet>> actuallyNearestLanelets =
-      geometry::findNearest(laneletMap.laneletLayer, BasicPoint2d(0, 0), 1);
+      traced("geometry::findNearest", [&] {
+        return geometry::findNearest(laneletMap.laneletLayer,
+                                     BasicPoint2d(0, 0), 1);
+      });
   assert(!actuallyNearestLanelets.empty());
 
   // finally we can get primitives using a search region (this also runs on the
   // bounding boxes) this returns all lanelets whose bounding box intersects
   // with the query
-  Lanelets inRegion = laneletMap.laneletLayer.search(
-      BoundingBox2d(BasicPoint2d(0, 0), BasicPoint2d(10, 10)));
+  Lanelets inRegion = traced("LaneletLayer::search", [&] {
+    return laneletMap.laneletLayer.search(
+        BoundingBox2d(BasicPoint2d(0, 0), BasicPoint2d(10, 10)));
+  });
+  LANELET_TUTORIAL_COUNT("LaneletLayer::search", "results", inRegion.size());
   assert(!inRegion.empty());
 
   // get the first lanelet whose distance from the query is 3> m
   BasicPoint2d searchPoint = BasicPoint2d(10, 10);
-  auto searchFunc = [&searchPoint](const BoundingBox2d &lltBox,
-                                   const Lanelet &) {
+  size_t visited = 0;
+  auto searchFunc = [&searchPoint, &visited](const BoundingBox2d &lltBox,
+                                             const Lanelet &) {
+    ++visited;
     return geometry::distance(searchPoint, lltBox) > 3;
   };
-  Optional<Lanelet> lanelet =
-      laneletMap.laneletLayer.nearestUntil(searchPoint, searchFunc);
+  Optional<Lanelet> lanelet = traced("LaneletLayer::nearestUntil", [&] {
+    return laneletMap.laneletLayer.nearestUntil(searchPoint, searchFunc);
+  });
+  // how many candidates the R-tree had to hand out until the query succeeded
+  LANELET_TUTORIAL_COUNT("LaneletLayer::nearestUntil", "visited", visited);
   assert(!!lanelet && geometry::distance(geometry::boundingBox2d(*lanelet),
                                          searchPoint) > 3);
 }
+
+void part4RegulatoryElementIndex() {
+  LaneletMap laneletMap = getLaneletMap();
+  // build once after loading the map, then query every cycle
+  RegulatoryElementIndex<TrafficLight> trafficLightIndex(laneletMap);
+  RegulatoryElementIndex<SpeedLimit> speedLimitIndex(laneletMap);
+
+  Lanelet mapLanelet = *laneletMap.laneletLayer.begin();
+  // same result as mapLanelet.regulatoryElementsAs<TrafficLight>(), but
+  // without casting or allocating
+  auto trafficLights = trafficLightIndex.of(mapLanelet);
+  assert(trafficLights.size() == 1);
+  assert(speedLimitIndex.of(mapLanelet).empty());
+
+  // reverse lookup from the light bulbs to the regulatory element
+  auto usages = trafficLightIndex.usingLineString(
+      *trafficLights.front()->trafficLights().front().lineString());
+  assert(usages.size() == 1 && usages.front() == trafficLights.front());
+}
@@ -4,8 +4,12 @@
 #include <lanelet2_core/utility/Units.h>
 #include <lanelet2_traffic_rules/TrafficRules.h>
 #include <lanelet2_traffic_rules/TrafficRulesFactory.h>
+#include <lanelet_tutorial/instrumentation.hpp>
+
+#include <iostream>
 
 using namespace lanelet;
+using lanelet_tutorial::instrumentation::traced;
 
 LineString3d getLineStringX(double x) {
   return LineString3d(utils::getId(), {Point3d(utils::getId(), x, 0, 0),
@@ -83,7 +87,9 @@ int main() {
   assert(!trafficRules->canPass(right, left));
 
   // we can also query the speed limit
-  traffic_rules::SpeedLimitInformation limit = trafficRules->speedLimit(right);
+  traffic_rules::SpeedLimitInformation limit =
+      traced("TrafficRules::speedLimit",
+             [&] { return trafficRules->speedLimit(right); });
   assert(limit.speedLimit == 50_kmh);
   assert(
       limit.isMandatory); // mandatory means we must not exceed the speed limit
@@ -99,7 +105,11 @@ int main() {
   left.attributes()[AttributeName::OneWay] = false;
 
   // now we can see that lane change is allowed
-  assert(trafficRules->canChangeLane(right, left));
+  bool canChangeLane =
+      traced("TrafficRules::canChangeLane",
+             [&] { return trafficRules->canChangeLane(right, left); });
+  assert(canChangeLane);
+  static_cast<void>(canChangeLane); // unused with NDEBUG
   assert(trafficRules->cahChangeLane(left, right));
 
   // and left is no drivable in inverted direction
@@ -122,6 +132,10 @@ int main() {
   // if the type of the lanelet is changed from road to walkway, it is not
   // longer drivable for vehicles
   right.attributes()[AttributeName::Subtype] = AttributeValueString::Crosswalk;
-  assert(!trafficRules->canPass(right));
+  bool vehicleCanPass = traced(
+      "TrafficRules::canPass", [&] { return trafficRules->canPass(right); });
+  assert(!vehicleCanPass);
+  static_cast<void>(vehicleCanPass);
   assert(pedestrianRules->canPass(right));
+  LANELET_TUTORIAL_TRACE_DUMP(std::cout);
 }
@@ -1,24 +1,36 @@
 #include <ament_index_cpp/get_package_share_directory.hpp>
 #include <lanelet2_extension/projection/mgrs_projector.hpp>
 #include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_core/geometry/Lanelet.h>
+#include <lanelet2_core/geometry/LineString.h>
 #include <lanelet2_io/Io.h>
 #include <lanelet2_routing/Route.h>
 #include <lanelet2_routing/RoutingGraph.h>
 #include <lanelet2_routing/RoutingGraphContainer.h>
 #include <lanelet2_routing/RoutingCost.h>
 #include <lanelet2_traffic_rules/TrafficRulesFactory.h>
+#include <lanelet_tutorial/instrumentation.hpp>
+#include <lanelet_tutorial/lookahead.hpp>
+#include <lanelet_tutorial/map_service.hpp>
+#include <lanelet_tutorial/map_validation.hpp>
+#include <lanelet_tutorial/route_corridor.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <set>
 #include <vector>
 
 using namespace lanelet;
 using namespace std;
+using lanelet_tutorial::instrumentation::traced;
 
 void part1CreatingAndUsingRoutingGraphs(const LaneletMapPtr map);
 void part2UsingRoutes(const LaneletMapPtr map);
 void part2_1(const LaneletMapPtr map);
 // void part3UsingRoutingGraphContainers(const LaneletMapPtr map);
+void part4UsingMapService(const string &path);
+void part5ValidatingMaps(const LaneletMapPtr map);
 
 int main() {
   // How to read lanelet2.osm
@@ -27,7 +39,9 @@ int main() {
   string fpath = path + "/mapping_example.osm";
   lanelet::ErrorMessages errors{};
   lanelet::projection::MGRSProjector projector{};
-  lanelet::LaneletMapPtr map = lanelet::load(fpath, projector, &errors);
+  lanelet::LaneletMapPtr map = traced("lanelet::load", [&] {
+    return lanelet::load(fpath, projector, &errors);
+  });
   for (auto &&error : errors)
     cout << error << endl;
   part1CreatingAndUsingRoutingGraphs(map);
@@ -35,11 +49,16 @@ int main() {
   fpath = path + "/kashiwanoha_intersection_area.osm";
   lanelet::ErrorMessages errors2{};
   lanelet::projection::MGRSProjector projector2{};
-  lanelet::LaneletMapPtr map2 = lanelet::load(fpath, projector2, &errors2);
+  lanelet::LaneletMapPtr map2 = traced("lanelet::load", [&] {
+    return lanelet::load(fpath, projector2, &errors2);
+  });
   for (auto &&error : errors2)
     cout << error << endl;
   part2_1(map2);
   // part3UsingRoutingGraphContainers(map);
+  part4UsingMapService(path);
+  part5ValidatingMaps(map2);
+  LANELET_TUTORIAL_TRACE_DUMP(cout);
 }
 
 void part1CreatingAndUsingRoutingGraphs(const LaneletMapPtr map) {
@@ -48,7 +67,9 @@ void part1CreatingAndUsingRoutingGraphs(const LaneletMapPtr map) {
                                                  Participants::Vehicle);
   // routing graph varies depending on traffic rules
   routing::RoutingGraphPtr routingGraph =
-      routing::RoutingGraph::build(*map, *trafficRules);
+      traced("RoutingGraph::build", [&] {
+        return routing::RoutingGraph::build(*map, *trafficRules);
+      });
   ConstLanelet lanelet = map->laneletLayer.get(4984315);
   assert(!routingGraph->adjacentLeft(lanelet));
   assert(!routingGraph->adjacentRight(
@@ -69,8 +90,9 @@ void part1CreatingAndUsingRoutingGraphs(const LaneletMapPtr map) {
 
   // get all possible paths from here whose length is at least 100m
   /// 'false' flag exculdes lane-changing
-  routing::LaneletPaths paths =
-      routingGraph->possiblePaths(lanelet, 100, 0, false);
+  routing::LaneletPaths paths = traced("RoutingGraph::possiblePaths", [&] {
+    return routingGraph->possiblePaths(lanelet, 100, 0, false);
+  });
   assert(paths.size() == 1);
   // なんかVMBで見えるidと若干のずれがある
   cout << "path from 4984315: ";
@@ -79,7 +101,10 @@ void part1CreatingAndUsingRoutingGraphs(const LaneletMapPtr map) {
   cout << endl;
 
   /// if lane-change is 'true' we have more options
-  paths = routingGraph->possiblePaths(lanelet, 100, 0, true);
+  paths = traced("RoutingGraph::possiblePaths", [&] {
+    return routingGraph->possiblePaths(lanelet, 100, 0, true);
+  });
+  LANELET_TUTORIAL_COUNT("RoutingGraph::possiblePaths", "paths", paths.size());
   cout << "if lane-change is allowed in the flag, there  are " << paths.size()
        << " paths" << endl;
 
@@ -87,13 +112,18 @@ void part1CreatingAndUsingRoutingGraphs(const LaneletMapPtr map) {
   // in an unsorted order and contain no duplicates. Also, possiblePaths
   // discards paths that are below the cost threshold while reachable set keeps
   // them all
-  ConstLanelets reachableSet = routingGraph->reachableSet(lanelet, 100, 0);
+  ConstLanelets reachableSet = traced("RoutingGraph::reachableSet", [&] {
+    return routingGraph->reachableSet(lanelet, 100, 0);
+  });
+  LANELET_TUTORIAL_COUNT("RoutingGraph::reachableSet", "lanelets",
+                         reachableSet.size());
   cout << "there are " << reachableSet.size() << " reachable element" << endl;
 
   // obtain shortest path
   ConstLanelet toLanelet = map->laneletLayer.get(2925017);
   Optional<routing::LaneletPath> shortestPath =
-      routingGraph->shortestPath(lanelet, toLanelet, 1);
+      traced("RoutingGraph::shortestPath",
+             [&] { return routingGraph->shortestPath(lanelet, toLanelet, 1); });
   assert(!!shortestPath);
   /// the shortest path can contain sudden lane changes. You can query the path
   /// for the sequence or lanelets that you can follow until you must make a
@@ -102,6 +132,34 @@ void part1CreatingAndUsingRoutingGraphs(const LaneletMapPtr map) {
   for (auto &&way : lane)
     cout << way.id() << " ";
   cout << endl;
+
+  // if this is asked every cycle, bind the path once and move along it. The
+  // regulatory element indices are built once per map and can be shared
+  lanelet_tutorial::RegulatoryElementIndex<TrafficLight> trafficLights(*map);
+  lanelet_tutorial::RegulatoryElementIndex<RightOfWay> rightOfWays(*map);
+  lanelet_tutorial::LaneletLookahead lookahead(*routingGraph, *shortestPath,
+                                               trafficLights, rightOfWays);
+  for (auto it = shortestPath->begin(); it != shortestPath->end(); ++it) {
+    const ConstLanelet &current = *it;
+    bool onPath = lookahead.advance(current);
+    assert(onPath);
+    static_cast<void>(onPath);
+    // the same lanelets as the path computes on every call
+    LaneletSequence remaining = shortestPath->getRemainingLane(it);
+    assert(std::equal(remaining.begin(), remaining.end(),
+                      lookahead.remainingLane().begin(),
+                      lookahead.remainingLane().end()));
+    cout << current.id() << ": remaining lane of "
+         << lookahead.remainingLane().size() << " lanelets, lane change in "
+         << lookahead.distanceToLaneChange() << " m";
+    if (auto stopLine = lookahead.nextStopLine())
+      cout << ", stop line " << stopLine->element.id() << " in "
+           << stopLine->distance << " m";
+    if (auto trafficLight = lookahead.nextTrafficLight())
+      cout << ", traffic light " << trafficLight->element->id() << " in "
+           << trafficLight->distance << " m";
+    cout << endl;
+  }
 }
 
 void part2UsingRoutes(const LaneletMapPtr map) {
@@ -109,12 +167,17 @@ void part2UsingRoutes(const LaneletMapPtr map) {
       traffic_rules::TrafficRulesFactory::create(Locations::Germany,
                                                  Participants::Vehicle);
   routing::RoutingGraphUPtr routingGraph =
-      routing::RoutingGraph::build(*map, *trafficRules);
+      traced("RoutingGraph::build", [&] {
+        return routing::RoutingGraph::build(*map, *trafficRules);
+      });
   ConstLanelet lanelet = map->laneletLayer.get(4984315);
   ConstLanelet toLanelet = map->laneletLayer.get(2925017);
 
-  Optional<routing::Route> route =
-      routingGraph->getRoute(lanelet, toLanelet, 0);
+  Optional<routing::Route> route = traced("RoutingGraph::getRoute", [&] {
+    return routingGraph->getRoute(lanelet, toLanelet, 0);
+  });
+  LANELET_TUTORIAL_COUNT("RoutingGraph::getRoute", "lanelets",
+                         route->laneletSubmap()->laneletLayer.size());
 
   routing::LaneletPath shortestPath = route->shortestPath();
 
@@ -122,6 +185,33 @@ void part2UsingRoutes(const LaneletMapPtr map) {
   for (auto &&lane : fullLane)
     cout << lane.id() << " ";
   cout << endl;
+
+  // the drivable corridor along fullLane, including lane-changeable neighbours
+  lanelet_tutorial::RouteCorridor corridor(*routingGraph, *route, lanelet);
+  cout << "corridor boundary has " << corridor.left().points.size()
+       << " left and " << corridor.right().points.size() << " right points, "
+       << corridor.left().length() << " m long on the left" << endl;
+  // while driving, only the start of the corridor moves forward
+  double previousArcLength = -1.;
+  for (auto &&llt : fullLane) {
+    bool onCorridor = corridor.advance(llt);
+    assert(onCorridor);
+    static_cast<void>(onCorridor);
+    BasicPoint2d center = geometry::interpolatedPointAtDistance(
+        utils::to2D(llt.centerline()), 0.5 * geometry::length2d(llt));
+    assert(corridor.contains(center));
+    // the arc length along the corridor grows along the lane, and the point
+    // at that arc length is as far away as the projection says
+    auto projection = corridor.project(center);
+    assert(projection.left.length > previousArcLength);
+    previousArcLength = projection.left.length;
+    assert(std::abs((corridor.left().interpolate(projection.left.length) -
+                     center)
+                        .norm() -
+                    std::abs(projection.left.distance)) < 1e-6);
+    cout << llt.id() << ": s = " << projection.left.length
+         << " m, d = " << projection.left.distance << " m" << endl;
+  }
 }
 
 void part2_1(const LaneletMapPtr map) {
@@ -129,11 +219,16 @@ void part2_1(const LaneletMapPtr map) {
       traffic_rules::TrafficRulesFactory::create(Locations::Germany,
                                                  Participants::Vehicle);
   routing::RoutingGraphUPtr routingGraph =
-      routing::RoutingGraph::build(*map, *trafficRules);
+      traced("RoutingGraph::build", [&] {
+        return routing::RoutingGraph::build(*map, *trafficRules);
+      });
   ConstLanelet lanelet = map->laneletLayer.get(113);
   ConstLanelet toLanelet = map->laneletLayer.get(134);
-  Optional<routing::Route> route =
-      routingGraph->getRoute(lanelet, toLanelet, 0);
+  Optional<routing::Route> route = traced("RoutingGraph::getRoute", [&] {
+    return routingGraph->getRoute(lanelet, toLanelet, 0);
+  });
+  LANELET_TUTORIAL_COUNT("RoutingGraph::getRoute", "lanelets",
+                         route->laneletSubmap()->laneletLayer.size());
 
   routing::LaneletPath shortestPath = route->shortestPath();
 
@@ -144,7 +239,8 @@ void part2_1(const LaneletMapPtr map) {
   cout << endl;
 
   toLanelet = map->laneletLayer.get(112);
-  route = routingGraph->getRoute(lanelet, toLanelet, 0);
+  route = traced("RoutingGraph::getRoute",
+                 [&] { return routingGraph->getRoute(lanelet, toLanelet, 0); });
   shortestPath = route->shortestPath();
   fullLane = route->fullLane(lanelet);
   // looks like the map is not well configured.
@@ -155,3 +251,58 @@ void part2_1(const LaneletMapPtr map) {
 }
 
 // void part3UsingRoutingGraphContainers(const LaneletMapPtr map);
+
+void part4UsingMapService(const string &path) {
+  using lanelet_tutorial::service::MapService;
+  using lanelet_tutorial::service::RequestSuperseded;
+  MapService service(traffic_rules::TrafficRulesFactory::create(
+                         Locations::Germany, Participants::Vehicle),
+                     make_shared<projection::MGRSProjector>());
+
+  // load and graph building run in the background, the caller only blocks if
+  // it waits for the future
+  auto loaded = service.loadAsync(path + "/mapping_example.osm");
+  loaded.wait();
+  for (auto &&error : loaded.get()->loadErrors)
+    cout << error << endl;
+
+  // the second request on the "route" channel supersedes the first one, if
+  // the first one has not finished yet
+  auto first = service.routeAsync(4984315, 2925017);
+  auto second = service.routeAsync(4984315, 2925017);
+  try {
+    first.get();
+  } catch (const RequestSuperseded &) {
+    cout << "first route request was superseded" << endl;
+  }
+  MapService::RouteResult result = second.get();
+  for (auto &&lane : result.route->fullLane(
+           result.snapshot->map->laneletLayer.get(4984315)))
+    cout << lane.id() << " ";
+  cout << endl;
+
+  // while another map is loaded, queries are served from the current one
+  auto reloaded =
+      service.loadAsync(path + "/kashiwanoha_intersection_area.osm");
+  auto onOldMap = service.shortestPathAsync(4984315, 2925017);
+  cout << "shortest path on map version " << onOldMap.get().snapshot->version
+       << endl;
+  reloaded.wait();
+  auto onNewMap = service.routeAsync(113, 134).get();
+  cout << "route on map version " << onNewMap.snapshot->version << endl;
+}
+
+void part5ValidatingMaps(const LaneletMapPtr map) {
+  traffic_rules::TrafficRulesPtr trafficRules =
+      traffic_rules::TrafficRulesFactory::create(Locations::Germany,
+                                                 Participants::Vehicle);
+  routing::RoutingGraphUPtr routingGraph =
+      routing::RoutingGraph::build(*map, *trafficRules);
+  // the checks run on all cores; the JSON report can gate a map release
+  lanelet_tutorial::validation::Report report =
+      traced("MapValidator::run", [&] {
+        return lanelet_tutorial::validation::MapValidator(*map, *routingGraph)
+            .run();
+      });
+  report.writeJson(cout);
+}
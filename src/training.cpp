@@ -2,7 +2,15 @@
 #include <lanelet2_extension/projection/mgrs_projector.hpp>
 #include <lanelet2_core/LaneletMap.h>
 #include <lanelet2_io/Io.h>
+#include <lanelet2_routing/RoutingGraph.h>
+#include <lanelet2_traffic_rules/TrafficRulesFactory.h>
+#include <lanelet_tutorial/compact_map.hpp>
+#include <lanelet_tutorial/flat_map.hpp>
+#include <lanelet_tutorial/flat_map_writer.hpp>
+#include <lanelet_tutorial/instrumentation.hpp>
+#include <lanelet_tutorial/map_validation.hpp>
 
+#include <filesystem>
 #include <iostream>
 #include <set>
 #include <vector>
@@ -16,10 +24,24 @@ int main() {
   path += "/kashiwanoha_intersection_area.osm";
   lanelet::ErrorMessages errors{};
   lanelet::projection::MGRSProjector projector{};
-  lanelet::LaneletMapPtr map = lanelet::load(path, projector, &errors);
+  lanelet::LaneletMapPtr map =
+      lanelet_tutorial::instrumentation::traced("lanelet::load", [&] {
+        return lanelet::load(path, projector, &errors);
+      });
   for (auto &&error : errors)
     cout << error << endl;
 
+  // How to check the map beyond the parser errors
+  {
+    auto trafficRules = lanelet::traffic_rules::TrafficRulesFactory::create(
+        lanelet::Locations::Germany, lanelet::Participants::Vehicle);
+    auto routingGraph =
+        lanelet::routing::RoutingGraph::build(*map, *trafficRules);
+    lanelet_tutorial::validation::MapValidator(*map, *routingGraph)
+        .run()
+        .writeText(cout);
+  }
+
   // How to query point/linestring/area by id()
   lanelet::PointLayer &points = map->pointLayer;
   lanelet::LineStringLayer &linestrings = map->lineStringLayer;
@@ -66,5 +88,45 @@ int main() {
          << ", z = " << point1886.z() << endl;
   }
 
+  // How to share the map geometry with other processes
+  {
+    // written once; readers mmap the file (or shared memory) and use it in
+    // place, they only need flat_map.hpp
+    auto flatPath = std::filesystem::temp_directory_path() /
+                    "kashiwanoha_intersection_area.flatmap";
+    lanelet_tutorial::flat_map::writeFlatMap(*map, flatPath.string());
+    lanelet_tutorial::flat_map::MappedFlatMap mapped(flatPath.string());
+    // the mapping stays valid after the file is removed
+    std::filesystem::remove(flatPath);
+    auto view = mapped.view();
+    const auto *point1886 = view.findPoint(1886);
+    cout << "flat map: x = " << point1886->x << ", y = " << point1886->y
+         << ", z = " << point1886->z << endl;
+    const auto *l59 = view.findLanelet(59);
+    const auto &l59left = view.lineStrings()[l59->leftBound];
+    // points are in the order of the line string, see FlatLanelet::flags
+    // for whether the bound is inverted
+    cout << "point id of l59 in the flat map" << endl;
+    for (auto &&index : view.pointIndices(l59left))
+      cout << view.points()[index].id << endl;
+  }
+
+  // How to keep a compressed copy of the geometry
+  {
+    lanelet_tutorial::compact::CompactMap compact(*map);
+    cout << "compact map: " << compact.numPoints() << " points in "
+         << "about " << compact.memoryUsage() << " bytes" << endl;
+    // coordinates are decoded on the fly, accurate to 1 mm
+    auto point1886 = compact.point(1886);
+    cout << "x = " << point1886->x() << ", y = " << point1886->y()
+         << ", z = " << point1886->z() << endl;
+    lanelet::ConstLineString3d l59left = map->laneletLayer.get(59).leftBound();
+    cout << "distance from point 1886 to the left bound of l59 = "
+         << compact.distance2d(l59left.id(), point1886->x(), point1886->y())
+         << endl;
+  }
+
   // How to get a route
+
+  LANELET_TUTORIAL_TRACE_DUMP(cout);
 }